@@ -0,0 +1,144 @@
+#!/bin/bash
+
+# Checks the savestate checkpoints of render-node.sh with a stub doomgeneric
+#
+# The stub replays the input lines, the last field of each being the number of frames of the line. Its savestate
+# is the input replayed so far and its output is the whole replayed input. So a savestate written at the frame
+# given by 't2d-checkpoints plan' must hold exactly the history of its node, and a render resumed with the suffix
+# from 't2d-checkpoints find' must replay exactly the history of the rendered node.
+#
+# Usage: ./check-checkpoints.sh (after building the tools)
+#
+
+wd=$(dirname $0)
+cd $wd
+wd=$(pwd)
+
+bin="$wd/build/bin"
+
+tmp=$(mktemp -d)
+trap "rm -rf $tmp" EXIT
+
+# render-node.sh works relative to its own folder
+cp $wd/render-node.sh $tmp/
+mkdir -p $tmp/build $tmp/doomreplay $tmp/public/data/nodes $tmp/public/data/processed
+ln -s $bin $tmp/build/bin
+
+cat > $tmp/doomreplay/doomgeneric << 'EOF'
+#!/bin/bash
+state=""
+input=""
+output=""
+savestate=""
+saveframe=-1
+while [ $# -gt 0 ] ; do
+    case $1 in
+        -loadstate)       state=$2     ; shift ;;
+        -input)           input=$2     ; shift ;;
+        -output)          output=$2    ; shift ;;
+        -savestate)       savestate=$2 ; shift ;;
+        -savestate_frame) saveframe=$2 ; shift ;;
+    esac
+    shift
+done
+
+: > $output
+if [ -n "$state" ] ; then cat $state > $output ; fi
+
+frame=0
+while IFS= read -r line || [ -n "$line" ] ; do
+    echo "$line" >> $output
+    frame=$(($frame + ${line##* }))
+    if [ -n "$savestate" ] && [ $frame -eq $saveframe ] ; then cp $output $savestate ; fi
+done < $input
+
+if [ -n "$savestate" ] && [ ! -f $savestate ] ; then
+    echo "stub: frame $saveframe is not at the end of an input line" >&2
+    exit 1
+fi
+EOF
+chmod +x $tmp/doomreplay/doomgeneric
+
+data=$tmp/public/data
+
+# a chain of nodes 1000 + depth, and a branch 2000 + depth off the node at depth 22
+function add_node {
+    id=$1
+    parent=$2
+    depth=$3
+    frames=$4
+
+    mkdir -p $data/nodes/$id $data/processed/$((id + 100000))
+    echo "$depth" > $data/nodes/$id/depth
+    echo "$((id + 100000))" > $data/nodes/$id/parent_id
+    echo "$parent" > $data/processed/$((id + 100000))/parent_id
+
+    # the node adds one input line of 1 to 5 frames to the history of its parent
+    n=$(( (id*7) % 5 + 1 ))
+    {
+        if [ "$parent" != "0" ] ; then cat $data/nodes/$parent/history.txt ; fi
+        echo "user$id w,a $n"
+    } > $data/nodes/$id/history.txt
+    echo "$(($frames + $n))" > $data/nodes/$id/frames
+}
+
+add_node 1000 0 0 0
+for depth in `seq 1 35` ; do
+    add_node $((1000 + depth)) $((1000 + depth - 1)) $depth $(cat $data/nodes/$((1000 + depth - 1))/frames)
+done
+add_node 2023 1022 23 $(cat $data/nodes/1022/frames)
+for depth in `seq 24 27` ; do
+    add_node $((2000 + depth)) $((2000 + depth - 1)) $depth $(cat $data/nodes/$((2000 + depth - 1))/frames)
+done
+
+$bin/t2d-history import $data $data/history > /dev/null || exit 1
+
+nfailed=0
+
+# renders the node and checks the replay and the checkpoints that are expected to exist afterwards
+function check {
+    id=$1
+    shift
+
+    T2D_CHECKPOINTS=1 $tmp/render-node.sh $id 5 35 0 > $tmp/log.txt 2>&1
+    if [ $? -ne 0 ] ; then
+        echo "FAILED: render of $id"
+        cat $tmp/log.txt
+        nfailed=$(($nfailed + 1))
+        return
+    fi
+
+    if ! cmp -s $tmp/tmp/$id.mp4 $data/nodes/$id/history.txt ; then
+        echo "FAILED: the replay of $id does not match its history"
+        nfailed=$(($nfailed + 1))
+    fi
+
+    for checkpoint in "$@" ; do
+        if ! cmp -s $tmp/cache/checkpoints/$checkpoint/state $data/nodes/$checkpoint/history.txt ; then
+            echo "FAILED: the checkpoint of $checkpoint does not match its history"
+            nfailed=$(($nfailed + 1))
+        fi
+    done
+
+    echo "$id: $(grep -c "Resuming" $tmp/log.txt) resumed, checkpoints $(ls $tmp/cache/checkpoints | tr '\n' ' ')"
+}
+
+# two full replays at the same time, both write the checkpoint at depth 20
+T2D_CHECKPOINTS=1 $tmp/render-node.sh 2025 5 35 0 > $tmp/log_parallel.txt 2>&1 &
+check 1025
+wait $! || { echo "FAILED: render of 2025" ; cat $tmp/log_parallel.txt ; nfailed=$(($nfailed + 1)) ; }
+cmp -s $tmp/tmp/2025.mp4 $data/nodes/2025/history.txt || { echo "FAILED: the replay of 2025 does not match its history" ; nfailed=$(($nfailed + 1)) ; }
+cmp -s $tmp/cache/checkpoints/1020/state $data/nodes/1020/history.txt || { echo "FAILED: the checkpoint of 1020 does not match its history" ; nfailed=$(($nfailed + 1)) ; }
+# resumes from depth 20, writes the checkpoint at depth 30 - relative to the frames of depth 20
+check 1035 1020 1030
+# resumes from depth 20 on the other branch
+check 2027 1020 1030
+# resumes from depth 30
+check 1035 1020 1030
+
+if [ $nfailed -ne 0 ] ; then
+    echo "$nfailed checks failed"
+    exit 1
+fi
+
+echo "All checks passed"
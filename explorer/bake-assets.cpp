@@ -0,0 +1,210 @@
+// Build-time asset baker
+//
+// Packs the icons from the images folder into a single RGBA atlas and rasterizes the imgui fonts, so that the
+// explorer can upload the textures at startup without decoding or glyph rasterization.
+//
+// Usage: t2d-bake-assets path/to/images path/to/fonts path/to/explorer.assets
+//
+
+#include "core/assets.h"
+#include "core/baked-assets.h"
+
+#include "imgui/imgui.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include "stb/stb_image.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+
+namespace {
+    using Filename = const char *;
+
+    const std::map<::ImVid::Assets::Id, Filename> kFilenameAsset = {
+        { ::ImVid::Assets::ICON_T2D_BIG,           "logo-big.png" },
+        { ::ImVid::Assets::ICON_T2D_SMALL,         "logo-small.png" },
+        { ::ImVid::Assets::ICON_T2D_SMALL_BLUR,    "logo-small-blur.png" },
+        { ::ImVid::Assets::ICON_T2D_NODE_SELECTED, "node-selected.png" },
+    };
+
+    // icons are never drawn larger than this, so there is no point in keeping more texels
+    const int kMaxIconSize = 800;
+
+    // transparent border around each icon, so that the mipmaps of neighbours do not bleed into each other
+    const int kPadding = 8;
+
+    bool fileExists(const std::string & fname) {
+        std::ifstream fin(fname);
+        return fin.good();
+    }
+
+    // the same fonts as the fallback in main() of the explorer, rasterized by imgui
+    bool bakeFonts(const std::string & pathFonts, ::ImVid::BakedFonts & res) {
+        using BakedFonts = ::ImVid::BakedFonts;
+
+        const auto fnameText = pathFonts + "/DroidSans.ttf";
+        const auto fnameIcons = pathFonts + "/fontawesome-webfont.ttf";
+
+        if (fileExists(fnameText) == false || fileExists(fnameIcons) == false) {
+            fprintf(stderr, "Failed to find fonts in '%s'\n", pathFonts.c_str());
+            return false;
+        }
+
+        ImFontAtlas atlas;
+
+        {
+            printf("Rasterizing font '%s'\n", fnameText.c_str());
+            atlas.AddFontFromFileTTF(fnameText.c_str(), BakedFonts::kSizeText);
+
+            static const ImWchar ranges[] = { BakedFonts::kIconsFirst, BakedFonts::kIconsLast, 0 };
+
+            ImFontConfig config;
+            config.MergeMode = true;
+            config.GlyphOffset = { 0.0f, 0.0f };
+
+            printf("Rasterizing font '%s'\n", fnameIcons.c_str());
+            atlas.AddFontFromFileTTF(fnameIcons.c_str(), BakedFonts::kSizeText, &config, ranges);
+        }
+
+        {
+            ImFontConfig config;
+            config.SizePixels = BakedFonts::kSizeDefault;
+            atlas.AddFontDefault(&config);
+        }
+
+        unsigned char * pixels = nullptr;
+        int nx = 0;
+        int ny = 0;
+        atlas.GetTexDataAsAlpha8(&pixels, &nx, &ny);
+
+        if (pixels == nullptr) {
+            fprintf(stderr, "Failed to build font atlas\n");
+            return false;
+        }
+
+        res.imguiVersion = IMGUI_VERSION_NUM;
+
+        res.texSizeX = nx;
+        res.texSizeY = ny;
+        res.texAlpha.assign(pixels, pixels + nx*ny);
+
+        res.uvWhitePixel = { atlas.TexUvWhitePixel.x, atlas.TexUvWhitePixel.y };
+        res.uvLines.clear();
+        for (const auto & uv : atlas.TexUvLines) {
+            res.uvLines.push_back({ uv.x, uv.y, uv.z, uv.w });
+        }
+
+        res.fonts.clear();
+        for (const auto font : atlas.Fonts) {
+            BakedFonts::Font cur;
+            cur.size = font->FontSize;
+            cur.ascent = font->Ascent;
+            cur.descent = font->Descent;
+
+            for (const auto & glyph : font->Glyphs) {
+                cur.glyphs.push_back({
+                    (uint32_t) glyph.Codepoint, glyph.AdvanceX,
+                    glyph.X0, glyph.Y0, glyph.X1, glyph.Y1,
+                    glyph.U0, glyph.V0, glyph.U1, glyph.V1,
+                });
+            }
+
+            printf("  font %.0fpx, %d glyphs\n", cur.size, (int) cur.glyphs.size());
+
+            res.fonts.push_back(std::move(cur));
+        }
+
+        printf("  %d x %d font atlas\n", nx, ny);
+
+        return true;
+    }
+
+    // 2x2 box filter
+    void downsample(::ImVid::Atlas::Image & image) {
+        const int nx = image.nx/2;
+        const int ny = image.ny/2;
+
+        std::vector<uint8_t> res(4*nx*ny);
+        for (int y = 0; y < ny; ++y) {
+            for (int x = 0; x < nx; ++x) {
+                for (int c = 0; c < 4; ++c) {
+                    const int sum =
+                        image.pixels[4*((2*y + 0)*image.nx + 2*x + 0) + c] +
+                        image.pixels[4*((2*y + 0)*image.nx + 2*x + 1) + c] +
+                        image.pixels[4*((2*y + 1)*image.nx + 2*x + 0) + c] +
+                        image.pixels[4*((2*y + 1)*image.nx + 2*x + 1) + c];
+                    res[4*(y*nx + x) + c] = (sum + 2)/4;
+                }
+            }
+        }
+
+        image.nx = nx;
+        image.ny = ny;
+        image.pixels = std::move(res);
+    }
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s path/to/images path/to/fonts path/to/explorer.assets\n", argv[0]);
+        return -1;
+    }
+
+    const std::string pathImages = argv[1];
+    const std::string pathFonts = argv[2];
+    const char * fnameOut = argv[3];
+
+    std::vector<::ImVid::Atlas::Image> images;
+
+    for (const auto & [id, filename] : kFilenameAsset) {
+        const auto pathAsset = pathImages + "/" + filename;
+        printf("Loading image '%s'\n", pathAsset.c_str());
+
+        int nx, ny, nz;
+        uint8_t * data = stbi_load(pathAsset.c_str(), &nx, &ny, &nz, STBI_rgb_alpha);
+
+        if (data == nullptr) {
+            fprintf(stderr, "Failed to load image\n");
+            return -2;
+        }
+
+        ::ImVid::Atlas::Image image;
+        image.id = id;
+        image.nx = nx;
+        image.ny = ny;
+        image.pixels.assign(data, data + 4*nx*ny);
+
+        stbi_image_free(data);
+
+        while (std::max(image.nx, image.ny) > kMaxIconSize) {
+            downsample(image);
+        }
+
+        printf("  %d x %d -> %d x %d\n", nx, ny, image.nx, image.ny);
+
+        images.push_back(std::move(image));
+    }
+
+    ::ImVid::BakedAssets baked;
+    if (baked.icons.pack(images, kPadding) == false) {
+        return -3;
+    }
+
+    printf("  %d x %d icon atlas\n", baked.icons.sizeX, baked.icons.sizeY);
+
+    if (bakeFonts(pathFonts, baked.fonts) == false) {
+        return -4;
+    }
+
+    if (baked.write(fnameOut) == false) {
+        return -5;
+    }
+
+    printf("Written baked assets to '%s'\n", fnameOut);
+
+    return 0;
+}
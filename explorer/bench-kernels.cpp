@@ -0,0 +1,171 @@
+// Microbenchmark of the transform and culling kernels
+//
+// Runs the SIMD and the scalar versions of each kernel over the same random scene, checks that the
+// results match and prints the best time of several runs.
+//
+// Usage: t2d-bench-kernels [num_nodes] [num_runs]
+//
+
+#include "core/simd-kernels.h"
+#include "core/utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+    // world extent of the scene and size of the viewport - about a tenth of the scene is visible
+    const float kSceneSize = 100000.0f;
+    const float kViewSize = 0.3f*kSceneSize;
+
+    struct Scene {
+        std::vector<float> x;
+        std::vector<float> y;
+
+        // segments from each node to a nearby "parent"
+        std::vector<float> xb;
+        std::vector<float> yb;
+    };
+
+    Scene makeScene(int n) {
+        Scene res;
+        res.x.resize(n);
+        res.y.resize(n);
+        res.xb.resize(n);
+        res.yb.resize(n);
+
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> pos(0.0f, kSceneSize);
+        std::uniform_real_distribution<float> off(-2000.0f, 2000.0f);
+
+        for (int i = 0; i < n; ++i) {
+            res.x[i] = pos(rng);
+            res.y[i] = pos(rng);
+            res.xb[i] = res.x[i] + off(rng);
+            res.yb[i] = res.y[i] - 500.0f;
+        }
+
+        // a few zero-length segments
+        for (int i = 0; i < n; i += 997) {
+            res.xb[i] = res.x[i];
+            res.yb[i] = res.y[i];
+        }
+
+        return res;
+    }
+
+    // best of nRuns, in ms
+    float measure(int nRuns, const std::function<void()> & f) {
+        int64_t best = -1;
+        for (int r = 0; r < nRuns; ++r) {
+            const int64_t t0 = ::ImVid::t_us();
+            f();
+            const int64_t t1 = ::ImVid::t_us();
+            if (best < 0 || t1 - t0 < best) best = t1 - t0;
+        }
+
+        return 0.001f*best;
+    }
+
+    void report(const char * name, float tSimd_ms, float tScalar_ms, bool isOk) {
+        printf("%-16s  simd %8.3f ms  scalar %8.3f ms  speedup %5.2fx  %s\n",
+               name, tSimd_ms, tScalar_ms, tSimd_ms > 0.0f ? tScalar_ms/tSimd_ms : 0.0f, isOk ? "ok" : "MISMATCH");
+    }
+}
+
+int main(int argc, char ** argv) {
+    const int n = argc > 1 ? std::max(1, atoi(argv[1])) : 1000000;
+    const int nRuns = argc > 2 ? std::max(1, atoi(argv[2])) : 20;
+
+    printf("Backend: %s, %d lanes\n", ::ImVid::getSimdBackend(), ::ImVid::getSimdWidth());
+    printf("Elements: %d, runs: %d\n", n, nRuns);
+
+    const auto scene = makeScene(n);
+
+    const float x0 = 0.5f*(kSceneSize - kViewSize);
+    const float y0 = 0.5f*(kSceneSize - kViewSize);
+    const float x1 = x0 + kViewSize;
+    const float y1 = y0 + kViewSize;
+
+    const float sx = 1920.0f/kViewSize;
+    const float sy = 1080.0f/kViewSize;
+
+    int nFailed = 0;
+
+    {
+        std::vector<float> rx0(n), ry0(n), rx1(n), ry1(n);
+
+        const float tSimd = measure(nRuns, [&]() {
+            ::ImVid::transformPoints(n, scene.x.data(), scene.y.data(), x0, y0, sx, sy, rx0.data(), ry0.data());
+        });
+        const float tScalar = measure(nRuns, [&]() {
+            ::ImVid::transformPointsScalar(n, scene.x.data(), scene.y.data(), x0, y0, sx, sy, rx1.data(), ry1.data());
+        });
+
+        const bool isOk = rx0 == rx1 && ry0 == ry1;
+        report("transform", tSimd, tScalar, isOk);
+        nFailed += isOk ? 0 : 1;
+    }
+
+    {
+        std::vector<int32_t> res0(n), res1(n);
+        int m0 = 0;
+        int m1 = 0;
+
+        const float tSimd = measure(nRuns, [&]() {
+            m0 = ::ImVid::cullPoints(n, scene.x.data(), scene.y.data(), x0, y0, x1, y1, res0.data());
+        });
+        const float tScalar = measure(nRuns, [&]() {
+            m1 = ::ImVid::cullPointsScalar(n, scene.x.data(), scene.y.data(), x0, y0, x1, y1, res1.data());
+        });
+
+        const bool isOk = m0 == m1 && std::equal(res0.begin(), res0.begin() + m0, res1.begin());
+        report("cull points", tSimd, tScalar, isOk);
+        printf("                  visible: %d\n", m0);
+        nFailed += isOk ? 0 : 1;
+    }
+
+    {
+        std::vector<int32_t> res0(n), res1(n);
+        int m0 = 0;
+        int m1 = 0;
+
+        const float tSimd = measure(nRuns, [&]() {
+            m0 = ::ImVid::cullSegments(n, scene.x.data(), scene.y.data(), scene.xb.data(), scene.yb.data(), x0, y0, x1, y1, res0.data());
+        });
+        const float tScalar = measure(nRuns, [&]() {
+            m1 = ::ImVid::cullSegmentsScalar(n, scene.x.data(), scene.y.data(), scene.xb.data(), scene.yb.data(), x0, y0, x1, y1, res1.data());
+        });
+
+        const bool isOk = m0 == m1 && std::equal(res0.begin(), res0.begin() + m0, res1.begin());
+        report("cull segments", tSimd, tScalar, isOk);
+        printf("                  visible: %d\n", m0);
+        nFailed += isOk ? 0 : 1;
+    }
+
+    {
+        std::vector<float> dx(n), dy(n);
+        for (int i = 0; i < n; ++i) {
+            dx[i] = scene.xb[i] - scene.x[i];
+            dy[i] = scene.yb[i] - scene.y[i];
+        }
+
+        std::vector<float> nx0(n), ny0(n), nx1(n), ny1(n);
+
+        const float tSimd = measure(nRuns, [&]() {
+            ::ImVid::segmentNormals(n, dx.data(), dy.data(), 2.0f, nx0.data(), ny0.data());
+        });
+        const float tScalar = measure(nRuns, [&]() {
+            ::ImVid::segmentNormalsScalar(n, dx.data(), dy.data(), 2.0f, nx1.data(), ny1.data());
+        });
+
+        const bool isOk = nx0 == nx1 && ny0 == ny1;
+        report("segment normals", tSimd, tScalar, isOk);
+        nFailed += isOk ? 0 : 1;
+    }
+
+    return nFailed;
+}
@@ -0,0 +1,301 @@
+// Benchmark of the memory locality of the node storage
+//
+// Loads the same random scene into the node storage of the explorer in id order, Morton order and Hilbert order
+// and runs the same viewport queries over each. Like in main.cpp, the nodes are entries of an
+// std::unordered_map<int64_t, Node>, inserted in the load order, and the tree structures reach them through a
+// vector of Node pointers indexed by the dense node index. The visible nodes are found through an x-sorted index
+// of dense indices, like the level layout, and the fields read by the node rendering are then loaded through the
+// pointers. Prints the best wall time of several runs and the misses of a simulated set-associative LRU cache per
+// visible node, counting the pointer and the Node entry.
+//
+// Usage: t2d-bench-locality [num_nodes] [num_queries]
+//
+
+#include "core/space-filling-curve.h"
+#include "core/utils.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    const float kSceneSize = 100000.0f;
+    const int kNumRuns = 5;
+
+    // same fields as Node in main.cpp
+    struct Node {
+        int64_t id;
+        int64_t parentId;
+        std::string username;
+        int level;
+        int type;
+        float x;
+        float y;
+        int frames = 0;
+
+        int32_t idx = -1;
+    };
+
+    struct Cache {
+        Cache(int sizeBytes, int nWays) : nWays(nWays) {
+            nSets = sizeBytes/kLineSize/nWays;
+            tags.assign(nSets*nWays, -1);
+        }
+
+        static constexpr int kLineSize = 64;
+
+        int nSets = 0;
+        int nWays = 0;
+
+        int64_t nAccesses = 0;
+        int64_t nMisses = 0;
+
+        // each set is kept in LRU order, most recent first
+        std::vector<int64_t> tags;
+
+        void access(const void * p) {
+            const int64_t line = (int64_t) (reinterpret_cast<uintptr_t>(p)/kLineSize);
+            int64_t * set = tags.data() + (line % nSets)*nWays;
+
+            ++nAccesses;
+
+            int w = 0;
+            while (w < nWays && set[w] != line) ++w;
+            if (w == nWays) {
+                ++nMisses;
+                w = nWays - 1;
+            }
+
+            for (; w > 0; --w) set[w] = set[w - 1];
+            set[0] = line;
+        }
+    };
+
+    struct Query {
+        float x0;
+        float y0;
+        float x1;
+        float y1;
+    };
+
+    struct Storage {
+        std::unordered_map<int64_t, Node> nodes;
+
+        // TreeData::treeNodes - by dense index, which follows the insertion order
+        std::vector<const Node *> treeNodes;
+
+        // x-sorted index of dense indices
+        std::vector<float> indexX;
+        std::vector<float> indexY;
+        std::vector<int32_t> indexIdx;
+    };
+
+    // the ids are the creation order of the nodes, which has no relation to their position
+    void makeStorage(const std::vector<float> & x, const std::vector<float> & y, const std::vector<int32_t> & order, Storage & res) {
+        const int n = (int) order.size();
+
+        res.nodes.clear();
+        res.treeNodes.resize(n);
+        for (int i = 0; i < n; ++i) {
+            const int j = order[i];
+
+            auto & node = res.nodes[j + 1];
+            node.id = j + 1;
+            node.parentId = j/2;
+            node.username = "user" + std::to_string(j % 100000);
+            node.level = j % 64;
+            node.type = 1 + j % 3;
+            node.x = x[j];
+            node.y = y[j];
+            node.idx = i;
+
+            res.treeNodes[i] = &node;
+        }
+
+        std::vector<int32_t> byX(n);
+        for (int i = 0; i < n; ++i) byX[i] = i;
+        std::sort(byX.begin(), byX.end(), [&](int32_t a, int32_t b) { return res.treeNodes[a]->x < res.treeNodes[b]->x; });
+
+        res.indexX.resize(n);
+        res.indexY.resize(n);
+        res.indexIdx.resize(n);
+        for (int i = 0; i < n; ++i) {
+            res.indexX[i] = res.treeNodes[byX[i]]->x;
+            res.indexY[i] = res.treeNodes[byX[i]]->y;
+            res.indexIdx[i] = byX[i];
+        }
+    }
+
+    void getVisible(const Storage & storage, const Query & q, std::vector<int32_t> & visible) {
+        visible.clear();
+
+        const auto b = std::lower_bound(storage.indexX.begin(), storage.indexX.end(), q.x0) - storage.indexX.begin();
+        const auto e = std::upper_bound(storage.indexX.begin(), storage.indexX.end(), q.x1) - storage.indexX.begin();
+        for (auto i = b; i < e; ++i) {
+            if (storage.indexY[i] < q.y0 || storage.indexY[i] > q.y1) continue;
+            visible.push_back(storage.indexIdx[i]);
+        }
+    }
+
+    struct Result {
+        float t_ms = 0.0f;
+        int64_t nVisible = 0;
+        double checksum = 0.0;
+
+        int64_t nMissesL1 = 0;
+        int64_t nMissesL2 = 0;
+    };
+
+    // reads the visible nodes - in the order of the index, or sorted by dense index, which is how a renderer
+    // that walks spatial index leaves or fills an instance buffer would touch them
+    Result run(const Storage & storage, const std::vector<Query> & queries, bool isSorted) {
+        Result res;
+
+        std::vector<int32_t> visible;
+        visible.reserve(storage.treeNodes.size());
+
+        for (int r = 0; r < kNumRuns; ++r) {
+            int64_t nVisible = 0;
+            double checksum = 0.0;
+
+            const int64_t t0 = ::ImVid::t_us();
+            for (const auto & q : queries) {
+                getVisible(storage, q, visible);
+                if (isSorted) std::sort(visible.begin(), visible.end());
+
+                // the fields of the node rendering
+                for (const auto idx : visible) {
+                    const auto & node = *storage.treeNodes[idx];
+                    checksum += node.id + node.type + node.level + node.username.size();
+                }
+                nVisible += visible.size();
+            }
+            const float t_ms = 0.001f*(::ImVid::t_us() - t0);
+
+            if (r == 0 || t_ms < res.t_ms) res.t_ms = t_ms;
+            res.nVisible = nVisible;
+            res.checksum = checksum;
+        }
+
+        Cache l1(32*1024, 8);
+        Cache l2(1024*1024, 16);
+        for (const auto & q : queries) {
+            getVisible(storage, q, visible);
+            if (isSorted) std::sort(visible.begin(), visible.end());
+
+            for (const auto idx : visible) {
+                const auto * pp = &storage.treeNodes[idx];
+                const auto * p = *pp;
+                l1.access(pp);
+                l2.access(pp);
+                l1.access(p);
+                l2.access(p);
+            }
+        }
+        res.nMissesL1 = l1.nMisses;
+        res.nMissesL2 = l2.nMisses;
+
+        return res;
+    }
+
+    void report(const char * name, const Result & r, const Result & base) {
+        const double nVisible = std::max<int64_t>(1, r.nVisible);
+        printf("  %-10s  %9.3f ms  L1 miss/node %6.3f (%5.2fx)  L2 miss/node %6.3f (%5.2fx)\n",
+               name, r.t_ms,
+               r.nMissesL1/nVisible, r.nMissesL1 > 0 ? double(base.nMissesL1)/r.nMissesL1 : 0.0,
+               r.nMissesL2/nVisible, r.nMissesL2 > 0 ? double(base.nMissesL2)/r.nMissesL2 : 0.0);
+    }
+}
+
+int main(int argc, char ** argv) {
+    const int n = argc > 1 ? std::max(1, atoi(argv[1])) : 1000000;
+    const int nQueries = argc > 2 ? std::max(1, atoi(argv[2])) : 200;
+
+    printf("Nodes: %d, queries: %d, node: %d bytes\n", n, nQueries, (int) sizeof(Node));
+
+    // clustered positions, roughly like the subtrees of a laid out tree
+    std::vector<float> x(n);
+    std::vector<float> y(n);
+    {
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> pos(0.0f, kSceneSize);
+        std::normal_distribution<float> off(0.0f, 0.01f*kSceneSize);
+
+        const int nClusters = std::max(1, n/1000);
+        std::vector<float> cx(nClusters);
+        std::vector<float> cy(nClusters);
+        for (int i = 0; i < nClusters; ++i) {
+            cx[i] = pos(rng);
+            cy[i] = pos(rng);
+        }
+
+        std::uniform_int_distribution<int> cluster(0, nClusters - 1);
+        for (int i = 0; i < n; ++i) {
+            const int c = cluster(rng);
+            x[i] = std::min(kSceneSize, std::max(0.0f, cx[c] + off(rng)));
+            y[i] = std::min(kSceneSize, std::max(0.0f, cy[c] + off(rng)));
+        }
+    }
+
+    // viewports from a few percent to a quarter of the scene
+    std::vector<Query> queries(nQueries);
+    {
+        std::mt19937 rng(5678);
+        std::uniform_real_distribution<float> size(0.02f*kSceneSize, 0.25f*kSceneSize);
+        std::uniform_real_distribution<float> pos(0.0f, 1.0f);
+
+        for (auto & q : queries) {
+            const float w = size(rng);
+            const float h = 0.5625f*w;
+            q.x0 = pos(rng)*(kSceneSize - w);
+            q.y0 = pos(rng)*(kSceneSize - h);
+            q.x1 = q.x0 + w;
+            q.y1 = q.y0 + h;
+        }
+    }
+
+    // the order of the data files before the curve order
+    std::vector<int32_t> orderId(n);
+    for (int i = 0; i < n; ++i) orderId[i] = i;
+
+    std::vector<int32_t> orderMorton;
+    std::vector<int32_t> orderHilbert;
+    if (::ImVid::getCurveOrder(::ImVid::ECurve::Morton, x, y, orderMorton) == false ||
+        ::ImVid::getCurveOrder(::ImVid::ECurve::Hilbert, x, y, orderHilbert) == false) {
+        fprintf(stderr, "Failed to compute the curve order\n");
+        return 1;
+    }
+
+    // each storage is loaded into a fresh heap region, like the explorer loads the tree once
+    Storage storageId;
+    Storage storageMorton;
+    Storage storageHilbert;
+    makeStorage(x, y, orderId, storageId);
+    makeStorage(x, y, orderMorton, storageMorton);
+    makeStorage(x, y, orderHilbert, storageHilbert);
+
+    int nFailed = 0;
+    for (const bool isSorted : { false, true }) {
+        printf("%s:\n", isSorted ? "Access in dense index order" : "Access in index order");
+
+        const auto rId = run(storageId, queries, isSorted);
+        const auto rMorton = run(storageMorton, queries, isSorted);
+        const auto rHilbert = run(storageHilbert, queries, isSorted);
+
+        report("id", rId, rId);
+        report("morton", rMorton, rId);
+        report("hilbert", rHilbert, rId);
+        printf("  visible per query: %.0f\n", double(rId.nVisible)/nQueries);
+
+        if (rMorton.nVisible != rId.nVisible || rHilbert.nVisible != rId.nVisible) {
+            fprintf(stderr, "Mismatch in the number of visible nodes\n");
+            ++nFailed;
+        }
+    }
+
+    return nFailed;
+}
@@ -0,0 +1,92 @@
+// Checks that the main loop goes idle after the view animations
+//
+// Replays the per-frame view update of the explorer (updatePre) and the redraw bookkeeping of its main loop for
+// each animation type, including the zoom out of focusNode(id, true) that starts and ends at the same view. The
+// loop must stop redrawing a couple of frames after the animation ends, with the view exactly at the target.
+//
+// Usage: t2d-check-redraw
+//
+
+#include "core/view-animation.h"
+
+#include <cstdio>
+
+namespace {
+    const float kFrameTime = 1.0f/60.0f;
+
+    struct View {
+        float x;
+        float y;
+        float z;
+    };
+
+    // returns the number of frames rendered after the end of the animation, -1 if the view missed the target
+    int run(int type, const View & v0, const View & v1, float duration) {
+        View viewCur = v0;
+
+        // focusNode() requests one frame
+        int nRedrawFrames = 1;
+
+        const float t0 = 1.0f;
+        const float t1 = t0 + duration;
+
+        int nFramesAfter = 0;
+        for (float T = t0; T < t1 + 5.0f; T += kFrameTime) {
+            bool isMoving = false;
+            bool isZooming = false;
+
+            isMoving  |= ::ImVid::interp(viewCur.x, v0.x, v1.x, t0, t1, T, type, false);
+            isMoving  |= ::ImVid::interp(viewCur.y, v0.y, v1.y, t0, t1, T, type, false);
+            isZooming |= ::ImVid::interp(viewCur.z, v0.z, v1.z, t0, t1, T, type, true);
+
+            // State::needsRedraw()
+            if (nRedrawFrames > 0 || isMoving || isZooming) {
+                nRedrawFrames = nRedrawFrames > 0 ? nRedrawFrames - 1 : 0;
+                if (T >= t1) ++nFramesAfter;
+            }
+        }
+
+        if (viewCur.x != v1.x || viewCur.y != v1.y || viewCur.z != v1.z) return -1;
+
+        return nFramesAfter;
+    }
+}
+
+int main(int /*argc*/, char ** /*argv*/) {
+    const View kNode = { 1200.0f, -340.0f, 0.999f };
+    const View kOther = { -500.0f, 800.0f, 0.4f };
+
+    struct Case {
+        const char * name;
+        int type;
+        View v0;
+        View v1;
+        float duration;
+    };
+
+    const Case cases[] = {
+        { "key pan",                       2, kOther, kNode, 0.3f, },
+        { "mouse zoom",                    1, kOther, kNode, 0.3f, },
+        { "focus",                         3, kOther, kNode, 3.0f, },
+        { "focus with zoom out",           4, kOther, kNode, 3.0f, },
+        { "focus with zoom out, in place", 4, kNode,  kNode, 3.0f, },
+    };
+
+    int nFailed = 0;
+    for (const auto & c : cases) {
+        const int nFramesAfter = run(c.type, c.v0, c.v1, c.duration);
+
+        // the frame that reaches the target is the only one after the end
+        const bool isOk = nFramesAfter >= 0 && nFramesAfter <= 1;
+        printf("%-32s : %s (%d frames after the end)\n", c.name, isOk ? "ok" : "FAILED", nFramesAfter);
+
+        if (isOk == false) ++nFailed;
+    }
+
+    if (nFailed > 0) {
+        printf("%d checks failed\n", nFailed);
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,8 +1,6 @@
 #include "core/assets.h"
 
-#define STB_IMAGE_IMPLEMENTATION
-#define STBI_ONLY_PNG
-#include "stb/stb_image.h"
+#include "core/atlas.h"
 
 #include <GLES2/gl2.h>
 #if defined(__EMSCRIPTEN__)
@@ -12,23 +10,18 @@
 #include <GLES2/gl2ext.h>
 #endif
 
+#include <cstdio>
+#include <cstring>
 #include <map>
-#include <string>
 
-namespace {
-    using Filename = const char *;
-
-    const std::map<::ImVid::Assets::Id, Filename> kFilenameAsset = {
-        { ::ImVid::Assets::ICON_T2D_BIG,           "logo-big.png" },
-        { ::ImVid::Assets::ICON_T2D_SMALL,         "logo-small.png" },
-        { ::ImVid::Assets::ICON_T2D_SMALL_BLUR,    "logo-small-blur.png" },
-        { ::ImVid::Assets::ICON_T2D_NODE_SELECTED, "node-selected.png" },
-    };
-}
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
 
 namespace ImVid {
 struct Assets::Data {
-    std::map<Assets::Id, Assets::TexId> texIds;
+    Assets::TexId texId = 0;
+    std::map<Assets::Id, Assets::UV> uvs;
 };
 
 Assets::Assets() : _data(new Data()) {
@@ -37,49 +30,60 @@ Assets::Assets() : _data(new Data()) {
 Assets::~Assets() {}
 
 Assets::TexId Assets::getTexId(Id id) const {
-    if (_data->texIds.find(id) == _data->texIds.end()) return 0;
-    return _data->texIds.at(id);
+    if (_data->uvs.find(id) == _data->uvs.end()) return 0;
+    return _data->texId;
 }
 
-bool Assets::load(const char * pathFolder) {
-    // todo: refactor this in separate method
-    // todo: load all remaining assets
-    for (const auto & aid : kFilenameAsset) {
-        int nx, ny, nz;
-        const auto curAId = aid.first;
-
-        std::string pathAsset(pathFolder);
-        pathAsset += std::string("/") + ::kFilenameAsset.at(curAId);
-        printf("Loading image '%s'\n", pathAsset.c_str());
+Assets::UV Assets::getUV(Id id) const {
+    if (_data->uvs.find(id) == _data->uvs.end()) return {};
+    return _data->uvs.at(id);
+}
 
-        uint8_t * data = stbi_load(pathAsset.c_str(), &nx, &ny, &nz, STBI_rgb_alpha);
+bool Assets::load(const Atlas & atlas) {
+    if (atlas.pixels.empty()) {
+        fprintf(stderr, "Failed to load assets - empty atlas\n");
+        return false;
+    }
 
-        if (data == nullptr) {
-            fprintf(stderr, "Failed to load image\n");
-            return false;
-        }
+    for (const auto & [id, rect] : atlas.rects) {
+        _data->uvs[Assets::Id(id)] = {
+            float(rect.x)/atlas.sizeX,
+            float(rect.y)/atlas.sizeY,
+            float(rect.x + rect.w)/atlas.sizeX,
+            float(rect.y + rect.h)/atlas.sizeY,
+        };
+    }
 
-        auto & curTexId = _data->texIds[curAId];
+    auto & curTexId = _data->texId;
 
-        GLint lastTexId;
+    GLint lastTexId;
 
-        glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexId);
-        glGenTextures(1, &curTexId);
-        glBindTexture(GL_TEXTURE_2D, curTexId);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        //glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &lastTexId);
+    glGenTextures(1, &curTexId);
+    glBindTexture(GL_TEXTURE_2D, curTexId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    //glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 #ifdef GL_UNPACK_ROW_LENGTH // Not on WebGL/ES
     glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 #endif
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, nx, ny, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlas.sizeX, atlas.sizeY, 0, GL_RGBA, GL_UNSIGNED_BYTE, atlas.pixels.data());
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    // the mip levels past Atlas::getMaxMipLevel() mix the texels of neighbouring icons - WebGL 1 cannot clamp
+    // the level, so there the icons bleed into each other when drawn that small
+    {
+        const char * version = (const char *) glGetString(GL_VERSION);
+        if (version == nullptr || strncmp(version, "OpenGL ES 2", 11) != 0) {
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, atlas.getMaxMipLevel());
+        }
+    }
 
-        printf("Loaded successfully, texId = %d\n", curTexId);
+    printf("Loaded successfully, %d x %d, %d icons, texId = %d\n", atlas.sizeX, atlas.sizeY, (int) atlas.rects.size(), curTexId);
 
-        glBindTexture(GL_TEXTURE_2D, lastTexId);
-    }
+    glBindTexture(GL_TEXTURE_2D, lastTexId);
 
     return true;
 }
@@ -4,6 +4,8 @@
 #include <memory>
 
 namespace ImVid {
+struct Atlas;
+
 class Assets {
 public:
     Assets();
@@ -18,9 +20,20 @@ public:
 
     using TexId = uint32_t;
 
+    // texture coordinates of an icon inside the atlas
+    struct UV {
+        float u0 = 0.0f;
+        float v0 = 0.0f;
+        float u1 = 1.0f;
+        float v1 = 1.0f;
+    };
+
+    // all icons share a single mipmapped atlas texture
     TexId getTexId(Id id) const;
+    UV getUV(Id id) const;
 
-    bool load(const char * pathFolder);
+    // uploads the atlas baked by t2d-bake-assets
+    bool load(const Atlas & atlas);
 
 private:
     struct Data;
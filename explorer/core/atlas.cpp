@@ -0,0 +1,101 @@
+#include "core/atlas.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace ImVid {
+
+bool Atlas::pack(const std::vector<Image> & images, int padding, int maxSize) {
+    std::vector<int> order(images.size());
+    for (int i = 0; i < (int) images.size(); ++i) order[i] = i;
+
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return images[a].ny > images[b].ny; });
+
+    for (int size = 64; size <= maxSize; size *= 2) {
+        std::map<int32_t, Rect> res;
+
+        // bottom-left skyline packing
+        struct Segment {
+            int x;
+            int y;
+            int w;
+        };
+
+        std::vector<Segment> skyline = { { 0, 0, size } };
+
+        bool fits = true;
+        for (auto i : order) {
+            const int w = images[i].nx + padding;
+            const int h = images[i].ny + padding;
+
+            int bestIdx = -1;
+            int bestX = 0;
+            int bestY = size;
+            for (int k = 0; k < (int) skyline.size(); ++k) {
+                const int x = skyline[k].x;
+                if (x + w + padding > size) break;
+
+                int y = 0;
+                for (int e = k; e < (int) skyline.size() && skyline[e].x < x + w; ++e) {
+                    y = std::max(y, skyline[e].y);
+                }
+
+                if (y + h + padding <= size && y < bestY) {
+                    bestIdx = k;
+                    bestX = x;
+                    bestY = y;
+                }
+            }
+
+            if (bestIdx < 0) {
+                fits = false;
+                break;
+            }
+
+            res[images[i].id] = { bestX + padding, bestY + padding, images[i].nx, images[i].ny };
+
+            // raise the skyline under the new rect
+            std::vector<Segment> updated;
+            for (const auto & segment : skyline) {
+                if (segment.x + segment.w <= bestX || segment.x >= bestX + w) {
+                    updated.push_back(segment);
+                    continue;
+                }
+                if (segment.x < bestX) {
+                    updated.push_back({ segment.x, segment.y, bestX - segment.x });
+                }
+                if (segment.x + segment.w > bestX + w) {
+                    updated.push_back({ bestX + w, segment.y, segment.x + segment.w - bestX - w });
+                }
+            }
+            updated.push_back({ bestX, bestY + h, w });
+            std::sort(updated.begin(), updated.end(), [](const Segment & a, const Segment & b) { return a.x < b.x; });
+
+            skyline = std::move(updated);
+        }
+
+        if (fits == false) continue;
+
+        sizeX = size;
+        sizeY = size;
+        this->padding = std::max(0, padding);
+        rects = std::move(res);
+        pixels.assign(4*sizeX*sizeY, 0);
+
+        for (const auto & image : images) {
+            const auto & rect = rects[image.id];
+            for (int iy = 0; iy < image.ny; ++iy) {
+                std::memcpy(pixels.data() + 4*((rect.y + iy)*sizeX + rect.x), image.pixels.data() + 4*iy*image.nx, 4*image.nx);
+            }
+        }
+
+        return true;
+    }
+
+    fprintf(stderr, "Failed to pack %d images in a %dx%d atlas\n", (int) images.size(), maxSize, maxSize);
+
+    return false;
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace ImVid {
+
+// RGBA texture atlas, packed at build time by bake-assets.cpp and uploaded as-is at runtime
+// serialized as part of BakedAssets
+struct Atlas {
+public:
+    struct Rect {
+        int32_t x = 0;
+        int32_t y = 0;
+        int32_t w = 0;
+        int32_t h = 0;
+    };
+
+    struct Image {
+        int32_t id = 0;
+        int32_t nx = 0;
+        int32_t ny = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    // skyline-pack (bottom-left) the images into the smallest power-of-two atlas that fits them, with padding
+    // transparent texels between the images and around the border
+    bool pack(const std::vector<Image> & images, int padding, int maxSize = 4096);
+
+    // the padding keeps the images from bleeding into each other only in the mip levels in which a texel covers
+    // at most padding texels of the full-size atlas - floor(log2(padding)), i.e. the first 3 levels for 8 texels
+    int getMaxMipLevel() const {
+        int res = 0;
+        while ((2 << res) <= padding) ++res;
+        return res;
+    }
+
+    int32_t sizeX = 0;
+    int32_t sizeY = 0;
+    int32_t padding = 0;
+
+    std::map<int32_t, Rect> rects;
+    std::vector<uint8_t> pixels;
+};
+
+}
@@ -0,0 +1,133 @@
+#include "core/baked-assets.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace {
+    const uint32_t kMagic = 0x41443254; // "T2DA"
+    const uint32_t kVersion = 5;
+
+    template <typename T>
+    void writeValue(std::ofstream & fout, const T & v) {
+        fout.write((const char *) &v, sizeof(v));
+    }
+
+    template <typename T>
+    void writeVector(std::ofstream & fout, const std::vector<T> & v) {
+        writeValue(fout, (int32_t) v.size());
+        fout.write((const char *) v.data(), v.size()*sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream & fin, T & v) {
+        return (bool) fin.read((char *) &v, sizeof(v));
+    }
+
+    template <typename T>
+    bool readVector(std::ifstream & fin, std::vector<T> & v) {
+        int32_t n = 0;
+        if (readValue(fin, n) == false || n < 0) return false;
+        v.resize(n);
+        return (bool) fin.read((char *) v.data(), n*sizeof(T));
+    }
+}
+
+namespace ImVid {
+
+bool BakedAssets::write(const char * fname) const {
+    std::ofstream fout(fname, std::ios::binary);
+    if (fout.good() == false) {
+        fprintf(stderr, "Failed to open '%s' for writing\n", fname);
+        return false;
+    }
+
+    writeValue(fout, kMagic);
+    writeValue(fout, kVersion);
+
+    // icons
+    writeValue(fout, icons.sizeX);
+    writeValue(fout, icons.sizeY);
+    writeValue(fout, icons.padding);
+    writeValue(fout, (int32_t) icons.rects.size());
+    for (const auto & [id, rect] : icons.rects) {
+        writeValue(fout, id);
+        writeValue(fout, rect);
+    }
+    writeVector(fout, icons.pixels);
+
+    // fonts
+    writeValue(fout, fonts.imguiVersion);
+    writeValue(fout, fonts.texSizeX);
+    writeValue(fout, fonts.texSizeY);
+    writeVector(fout, fonts.texAlpha);
+    writeValue(fout, fonts.uvWhitePixel);
+    writeVector(fout, fonts.uvLines);
+    writeValue(fout, (int32_t) fonts.fonts.size());
+    for (const auto & font : fonts.fonts) {
+        writeValue(fout, font.size);
+        writeValue(fout, font.ascent);
+        writeValue(fout, font.descent);
+        writeVector(fout, font.glyphs);
+    }
+
+    return fout.good();
+}
+
+bool BakedAssets::read(const char * fname) {
+    std::ifstream fin(fname, std::ios::binary);
+    if (fin.good() == false) {
+        fprintf(stderr, "Failed to open '%s'\n", fname);
+        return false;
+    }
+
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    if (readValue(fin, magic) == false || magic != kMagic ||
+        readValue(fin, version) == false || version != kVersion) {
+        fprintf(stderr, "Invalid baked assets file '%s'\n", fname);
+        return false;
+    }
+
+    bool ok = true;
+
+    // icons
+    {
+        int32_t nRects = 0;
+        ok = ok && readValue(fin, icons.sizeX) && readValue(fin, icons.sizeY) && readValue(fin, icons.padding) && readValue(fin, nRects) && nRects >= 0;
+
+        icons.rects.clear();
+        for (int i = 0; ok && i < nRects; ++i) {
+            int32_t id;
+            Atlas::Rect rect;
+            ok = ok && readValue(fin, id) && readValue(fin, rect);
+            icons.rects[id] = rect;
+        }
+
+        ok = ok && readVector(fin, icons.pixels) && (int64_t) icons.pixels.size() == 4ll*icons.sizeX*icons.sizeY;
+    }
+
+    // fonts
+    {
+        int32_t nFonts = 0;
+        ok = ok && readValue(fin, fonts.imguiVersion) && readValue(fin, fonts.texSizeX) && readValue(fin, fonts.texSizeY);
+        ok = ok && readVector(fin, fonts.texAlpha) && (int64_t) fonts.texAlpha.size() == 1ll*fonts.texSizeX*fonts.texSizeY;
+        ok = ok && readValue(fin, fonts.uvWhitePixel) && readVector(fin, fonts.uvLines);
+        ok = ok && readValue(fin, nFonts) && nFonts >= 0;
+
+        fonts.fonts.clear();
+        for (int i = 0; ok && i < nFonts; ++i) {
+            BakedFonts::Font font;
+            ok = ok && readValue(fin, font.size) && readValue(fin, font.ascent) && readValue(fin, font.descent) && readVector(fin, font.glyphs);
+            fonts.fonts.push_back(std::move(font));
+        }
+    }
+
+    if (ok == false) {
+        fprintf(stderr, "Truncated baked assets file '%s'\n", fname);
+        return false;
+    }
+
+    return true;
+}
+
+}
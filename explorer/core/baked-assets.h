@@ -0,0 +1,64 @@
+#pragma once
+
+#include "core/atlas.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace ImVid {
+
+// the imgui fonts of the explorer, rasterized at build time
+// the text font with the icons merged into it, followed by the default font - the explorer picks them by index
+// the glyph metrics are final - they are installed into the imgui atlas as they are
+struct BakedFonts {
+    // the fonts are rasterized at kScale times their size on screen and drawn scaled down
+    static constexpr float kScale = 2.0f;
+    static constexpr float kSizeText = 14.0f*kScale;
+    static constexpr float kSizeDefault = 13.0f*kScale;
+
+    // the fontawesome codepoints merged into the text font
+    static constexpr uint32_t kIconsFirst = 0xf000;
+    static constexpr uint32_t kIconsLast = 0xf3ff;
+
+    struct Glyph {
+        uint32_t codepoint;
+        float advanceX;
+        float x0, y0, x1, y1;
+        float u0, v0, u1, v1;
+    };
+
+    struct Font {
+        float size = 0.0f;
+        float ascent = 0.0f;
+        float descent = 0.0f;
+
+        std::vector<Glyph> glyphs;
+    };
+
+    // IMGUI_VERSION_NUM of the baker - the tables are only installed into the same imgui version
+    int32_t imguiVersion = 0;
+
+    int32_t texSizeX = 0;
+    int32_t texSizeY = 0;
+
+    // alpha only - the glyphs are white
+    std::vector<uint8_t> texAlpha;
+
+    std::array<float, 2> uvWhitePixel = { 0.0f, 0.0f };
+    std::vector<std::array<float, 4>> uvLines;
+
+    std::vector<Font> fonts;
+};
+
+// everything the explorer needs at startup, in a GPU-ready form
+// produced by t2d-bake-assets at build time
+struct BakedAssets {
+    Atlas icons;
+    BakedFonts fonts;
+
+    bool write(const char * fname) const;
+    bool read(const char * fname);
+};
+
+}
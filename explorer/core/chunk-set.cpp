@@ -0,0 +1,224 @@
+#include "core/chunk-set.h"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    // the wanted area extends this fraction of the view size on each side
+    const float kMargin = 0.5f;
+
+    // and as far as the view moves in this time at its current velocity
+    const float kPrefetchTime_s = 1.0f;
+
+    // a failed chunk waits this many updates before it is requested again, doubling with each failure
+    const int kRetryUpdates = 4;
+    const int kMaxRetryShift = 6;
+
+    bool intersects(const ImVid::ChunkSet::Chunk & chunk, const ImVid::ChunkSet::Rect & rect) {
+        return chunk.xmax >= rect.xmin && chunk.xmin <= rect.xmax && chunk.ymax >= rect.ymin && chunk.ymin <= rect.ymax;
+    }
+}
+
+namespace ImVid {
+
+ChunkSet::ChunkSet() {}
+
+ChunkSet::~ChunkSet() {}
+
+bool ChunkSet::init(int maxNodes, int maxInFlight) {
+    if (maxNodes <= 0 || maxInFlight <= 0) {
+        fprintf(stderr, "Invalid chunk set parameters: %d %d\n", maxNodes, maxInFlight);
+        return false;
+    }
+
+    clear();
+
+    m_maxNodes = maxNodes;
+    m_maxInFlight = maxInFlight;
+
+    return true;
+}
+
+void ChunkSet::clear() {
+    m_nUpdates = 0;
+    m_nInFlight = 0;
+    m_nNodesLoaded = 0;
+    m_nNodesLoading = 0;
+
+    m_chunks.clear();
+}
+
+int ChunkSet::add(const Chunk & chunk) {
+    if (chunk.name.empty() || chunk.nNodes < 0 || chunk.xmin > chunk.xmax || chunk.ymin > chunk.ymax) {
+        fprintf(stderr, "Invalid chunk '%s'\n", chunk.name.c_str());
+        return -1;
+    }
+
+    Entry entry;
+    entry.chunk = chunk;
+    m_chunks.push_back(std::move(entry));
+
+    return (int) m_chunks.size() - 1;
+}
+
+void ChunkSet::update(const Rect & view, float vx, float vy, std::vector<int> & toLoad, std::vector<int> & toEvict) {
+    toLoad.clear();
+    toEvict.clear();
+
+    ++m_nUpdates;
+
+    const float mx = kMargin*(view.xmax - view.xmin);
+    const float my = kMargin*(view.ymax - view.ymin);
+    const float dx = kPrefetchTime_s*vx;
+    const float dy = kPrefetchTime_s*vy;
+
+    const Rect wanted = {
+        std::min(view.xmin, view.xmin + dx) - mx,
+        std::min(view.ymin, view.ymin + dy) - my,
+        std::max(view.xmax, view.xmax + dx) + mx,
+        std::max(view.ymax, view.ymax + dy) + my,
+    };
+
+    const float cx = 0.5f*(view.xmin + view.xmax);
+    const float cy = 0.5f*(view.ymin + view.ymax);
+
+    // requested chunks first, then the visible ones, then the rest of the wanted area - nearest first
+    struct Candidate {
+        int rank;
+        float dist2;
+        int i;
+
+        bool operator<(const Candidate & other) const {
+            if (rank != other.rank) return rank < other.rank;
+            if (dist2 != other.dist2) return dist2 < other.dist2;
+            return i < other.i;
+        }
+    };
+
+    std::vector<Candidate> candidates;
+
+    // nodes that can be evicted to make room
+    int nNodesEvictable = 0;
+
+    for (int i = 0; i < (int) m_chunks.size(); ++i) {
+        auto & entry = m_chunks[i];
+
+        const bool isVisible = intersects(entry.chunk, view);
+        const bool isWanted = entry.isRequested || intersects(entry.chunk, wanted);
+
+        if (isWanted) {
+            entry.lastWanted = m_nUpdates;
+        }
+
+        if (entry.state == EState::Loaded && isWanted == false && entry.isPinned == false) {
+            nNodesEvictable += entry.chunk.nNodes;
+        }
+
+        if (entry.state != EState::Unloaded || isWanted == false || entry.retryAfter > m_nUpdates) continue;
+
+        const float ex = 0.5f*(entry.chunk.xmin + entry.chunk.xmax) - cx;
+        const float ey = 0.5f*(entry.chunk.ymin + entry.chunk.ymax) - cy;
+
+        candidates.push_back({ entry.isRequested ? 0 : isVisible ? 1 : 2, ex*ex + ey*ey, i });
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const auto & candidate : candidates) {
+        if (m_nInFlight >= m_maxInFlight) break;
+
+        auto & entry = m_chunks[candidate.i];
+
+        // when the view covers more than the budget, the chunks nearest to its center are loaded
+        const bool isRequested = candidate.rank == 0;
+        const int nNodesAfter = m_nNodesLoaded + m_nNodesLoading + entry.chunk.nNodes - nNodesEvictable;
+        if (isRequested == false && nNodesAfter > m_maxNodes) break;
+
+        entry.state = EState::Loading;
+        ++m_nInFlight;
+        m_nNodesLoading += entry.chunk.nNodes;
+
+        toLoad.push_back(candidate.i);
+    }
+
+    if (m_nNodesLoaded + m_nNodesLoading <= m_maxNodes) return;
+
+    // least recently wanted first
+    std::vector<int> evictable;
+    for (int i = 0; i < (int) m_chunks.size(); ++i) {
+        const auto & entry = m_chunks[i];
+        if (entry.state == EState::Loaded && entry.lastWanted < m_nUpdates && entry.isPinned == false) {
+            evictable.push_back(i);
+        }
+    }
+
+    std::sort(evictable.begin(), evictable.end(), [this](int a, int b) {
+        if (m_chunks[a].lastWanted != m_chunks[b].lastWanted) return m_chunks[a].lastWanted < m_chunks[b].lastWanted;
+        return a < b;
+    });
+
+    for (const auto i : evictable) {
+        if (m_nNodesLoaded + m_nNodesLoading <= m_maxNodes) break;
+
+        auto & entry = m_chunks[i];
+        entry.state = EState::Unloaded;
+        m_nNodesLoaded -= entry.chunk.nNodes;
+
+        toEvict.push_back(i);
+    }
+}
+
+bool ChunkSet::request(int i) {
+    if (i < 0 || i >= (int) m_chunks.size()) return false;
+
+    auto & entry = m_chunks[i];
+    entry.isRequested = entry.state != EState::Loaded;
+    entry.retryAfter = 0;
+
+    return true;
+}
+
+bool ChunkSet::setLoaded(int i) {
+    if (i < 0 || i >= (int) m_chunks.size() || m_chunks[i].state != EState::Loading) {
+        fprintf(stderr, "Chunk %d is not loading\n", i);
+        return false;
+    }
+
+    auto & entry = m_chunks[i];
+    entry.state = EState::Loaded;
+    entry.isRequested = false;
+    entry.nFailures = 0;
+
+    --m_nInFlight;
+    m_nNodesLoading -= entry.chunk.nNodes;
+    m_nNodesLoaded += entry.chunk.nNodes;
+
+    return true;
+}
+
+bool ChunkSet::setFailed(int i) {
+    if (i < 0 || i >= (int) m_chunks.size() || m_chunks[i].state != EState::Loading) {
+        fprintf(stderr, "Chunk %d is not loading\n", i);
+        return false;
+    }
+
+    auto & entry = m_chunks[i];
+    entry.state = EState::Unloaded;
+    entry.retryAfter = m_nUpdates + (int64_t(kRetryUpdates) << std::min(entry.nFailures, kMaxRetryShift));
+    ++entry.nFailures;
+
+    --m_nInFlight;
+    m_nNodesLoading -= entry.chunk.nNodes;
+
+    return true;
+}
+
+bool ChunkSet::setPinned(int i, bool isPinned) {
+    if (i < 0 || i >= (int) m_chunks.size()) return false;
+
+    m_chunks[i].isPinned = isPinned;
+
+    return true;
+}
+
+}
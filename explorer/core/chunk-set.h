@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ImVid {
+
+// Tracks the spatial chunks of a large tree and decides which ones to load and which ones to evict
+//
+// A chunk is wanted when its bounding box intersects the view, grown by a margin and stretched towards where
+// the view is moving. Wanted chunks are requested nearest first, a few at a time. Once the loaded nodes exceed
+// the budget, the chunks that are not wanted are evicted, least recently wanted first. Pinned chunks are never
+// evicted.
+//
+struct ChunkSet {
+public:
+    enum class EState {
+        Unloaded,
+        Loading,
+        Loaded,
+    };
+
+    struct Chunk {
+        std::string name;
+
+        float xmin;
+        float ymin;
+        float xmax;
+        float ymax;
+
+        int nNodes;
+    };
+
+    struct Rect {
+        float xmin;
+        float ymin;
+        float xmax;
+        float ymax;
+    };
+
+    ChunkSet();
+    ~ChunkSet();
+
+    bool init(int maxNodes, int maxInFlight);
+    void clear();
+
+    // returns the index of the chunk, -1 on invalid input
+    int add(const Chunk & chunk);
+
+    // view in world units, velocity in world units per second
+    // fills the chunks to request, which are then loading, and the loaded chunks to evict, which are then unloaded
+    void update(const Rect & view, float vx, float vy, std::vector<int> & toLoad, std::vector<int> & toEvict);
+
+    // requests the chunk with the next update, regardless of the view
+    bool request(int i);
+
+    // the outcome of a request - a failed chunk is requested again after a while
+    bool setLoaded(int i);
+    bool setFailed(int i);
+
+    bool setPinned(int i, bool isPinned);
+
+    int size() const { return (int) m_chunks.size(); }
+    const Chunk & get(int i) const { return m_chunks[i].chunk; }
+    EState getState(int i) const { return m_chunks[i].state; }
+
+    int getNumNodesLoaded() const { return m_nNodesLoaded; }
+    int getNumNodesLoading() const { return m_nNodesLoading; }
+
+private:
+    struct Entry {
+        Chunk chunk;
+        EState state = EState::Unloaded;
+
+        bool isPinned = false;
+        bool isRequested = false;
+
+        // update counter of the last time the chunk was wanted, for the eviction order
+        int64_t lastWanted = 0;
+
+        // failed loads are retried with a growing delay, in updates
+        int nFailures = 0;
+        int64_t retryAfter = 0;
+    };
+
+    int m_maxNodes = 0;
+    int m_maxInFlight = 0;
+
+    int64_t m_nUpdates = 0;
+    int m_nInFlight = 0;
+    int m_nNodesLoaded = 0;
+    int m_nNodesLoading = 0;
+
+    std::vector<Entry> m_chunks;
+};
+
+}
@@ -113,4 +113,19 @@ bool FrameBuffer::unbind() const {
     return true;
 }
 
+bool FrameBuffer::readPixel(int x, int y, std::array<uint8_t, 4> & rgba) const {
+    if (x < 0 || x >= m_sizeX || y < 0 || y >= m_sizeY) {
+        fprintf(stderr, "Attempt to read pixel (%d, %d) outside of frame buffer\n", x, y);
+        return false;
+    }
+
+    if (bind() == false) return false;
+
+    glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+
+    unbind();
+
+    return true;
+}
+
 }
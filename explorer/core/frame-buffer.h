@@ -19,6 +19,8 @@ public:
     bool setViewport() const;
     bool unbind() const;
 
+    bool readPixel(int x, int y, std::array<uint8_t, 4> & rgba) const;
+
     uint32_t getId() const { return m_id; }
     uint32_t getIdTex() const { return m_idTex; }
     uint32_t getIdDepth() const { return m_idDepth; }
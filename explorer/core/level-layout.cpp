@@ -0,0 +1,255 @@
+#include "core/level-layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <unordered_map>
+
+namespace ImVid {
+
+LevelLayout::LevelLayout() {}
+
+LevelLayout::~LevelLayout() {}
+
+bool LevelLayout::build(
+        const std::vector<float> & x,
+        const std::vector<float> & y,
+        const std::vector<int32_t> & levels,
+        const std::vector<int32_t> & types,
+        const std::vector<Index> & parents) {
+    clear();
+
+    const int n = (int) x.size();
+    if (n == 0) return false;
+
+    if ((int) y.size() != n || (int) levels.size() != n || (int) types.size() != n || (int) parents.size() != n) {
+        fprintf(stderr, "Level layout: inconsistent input sizes\n");
+        return false;
+    }
+
+    // level -> bucket
+    std::unordered_map<int32_t, int32_t> bucket;
+    for (int i = 0; i < n; ++i) {
+        if (bucket.find(levels[i]) == bucket.end()) {
+            const auto b = (int32_t) m_levels.size();
+            bucket[levels[i]] = b;
+
+            Level level;
+            level.level = levels[i];
+            level.ymin = level.ymax = level.eymin = level.eymax = y[i];
+            m_levels.push_back(level);
+        }
+    }
+
+    const int nLevels = (int) m_levels.size();
+
+    // the order of the buckets is by y, so that the visible band is a contiguous range
+    std::vector<int32_t> nNodes(nLevels, 0);
+    std::vector<int32_t> nCommands(nLevels, 0);
+    std::vector<int32_t> nEdges(nLevels, 0);
+    for (int i = 0; i < n; ++i) {
+        auto & level = m_levels[bucket[levels[i]]];
+        level.ymin = std::min(level.ymin, y[i]);
+        level.ymax = std::max(level.ymax, y[i]);
+
+        if (types[i] == kTypeCommand) {
+            ++nCommands[bucket[levels[i]]];
+        } else {
+            ++nNodes[bucket[levels[i]]];
+        }
+
+        if (parents[i] >= 0 && parents[i] < n && parents[i] != i) {
+            ++nEdges[bucket[levels[i]]];
+        }
+    }
+
+    std::vector<int32_t> order(nLevels);
+    for (int i = 0; i < nLevels; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int32_t a, int32_t b) {
+        if (m_levels[a].ymin != m_levels[b].ymin) return m_levels[a].ymin < m_levels[b].ymin;
+        return m_levels[a].level < m_levels[b].level;
+    });
+
+    {
+        std::vector<Level> sorted(nLevels);
+        std::vector<int32_t> remap(nLevels);
+        int32_t posItems = 0;
+        int32_t posEdges = 0;
+        for (int i = 0; i < nLevels; ++i) {
+            const auto b = order[i];
+            sorted[i] = m_levels[b];
+            remap[b] = i;
+
+            sorted[i].nodes    = { posItems, posItems + nNodes[b] };
+            posItems += nNodes[b];
+            sorted[i].commands = { posItems, posItems + nCommands[b] };
+            posItems += nCommands[b];
+            sorted[i].edges    = { posEdges, posEdges + nEdges[b] };
+            posEdges += nEdges[b];
+        }
+
+        m_levels = std::move(sorted);
+        for (auto & [level, b] : bucket) b = remap[b];
+
+        m_itemIdx.resize(posItems);
+        m_itemX.resize(posItems);
+        m_edgeSrc.resize(posEdges);
+        m_edgeDst.resize(posEdges);
+        m_edgeXmin.resize(posEdges);
+    }
+
+    // scatter into the runs
+    {
+        std::vector<int32_t> posNodes(nLevels);
+        std::vector<int32_t> posCommands(nLevels);
+        std::vector<int32_t> posEdges(nLevels);
+        for (int i = 0; i < nLevels; ++i) {
+            posNodes[i] = m_levels[i].nodes.begin;
+            posCommands[i] = m_levels[i].commands.begin;
+            posEdges[i] = m_levels[i].edges.begin;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            const auto b = bucket[levels[i]];
+            auto & level = m_levels[b];
+
+            const auto k = types[i] == kTypeCommand ? posCommands[b]++ : posNodes[b]++;
+            m_itemIdx[k] = i;
+            m_itemX[k] = x[i];
+
+            const auto p = parents[i];
+            if (p >= 0 && p < n && p != i) {
+                const auto e = posEdges[b]++;
+                m_edgeSrc[e] = i;
+                m_edgeDst[e] = p;
+                m_edgeXmin[e] = std::min(x[i], x[p]);
+
+                level.eymin = std::min(level.eymin, std::min(y[i], y[p]));
+                level.eymax = std::max(level.eymax, std::max(y[i], y[p]));
+                level.edgeMaxDx = std::max(level.edgeMaxDx, std::abs(x[i] - x[p]));
+            }
+        }
+    }
+
+    // sort each run by x - items and edges are sorted through a permutation to keep the arrays in sync
+    std::vector<int32_t> perm;
+    std::vector<Index> tmpIdx;
+    std::vector<float> tmpX;
+    const auto sortRun = [&](const Range & run, std::vector<Index> & idx, std::vector<float> & key, std::vector<Index> * other) {
+        const int m = run.end - run.begin;
+        if (m < 2) return;
+
+        perm.resize(m);
+        for (int i = 0; i < m; ++i) perm[i] = run.begin + i;
+        std::sort(perm.begin(), perm.end(), [&](int32_t a, int32_t b) {
+            if (key[a] != key[b]) return key[a] < key[b];
+            return idx[a] < idx[b];
+        });
+
+        tmpIdx.resize(m);
+        tmpX.resize(m);
+        for (int i = 0; i < m; ++i) {
+            tmpIdx[i] = idx[perm[i]];
+            tmpX[i] = key[perm[i]];
+        }
+        std::copy(tmpIdx.begin(), tmpIdx.end(), idx.begin() + run.begin);
+        std::copy(tmpX.begin(), tmpX.end(), key.begin() + run.begin);
+
+        if (other) {
+            for (int i = 0; i < m; ++i) tmpIdx[i] = (*other)[perm[i]];
+            std::copy(tmpIdx.begin(), tmpIdx.end(), other->begin() + run.begin);
+        }
+    };
+
+    m_levelYmin.resize(nLevels);
+    for (int i = 0; i < nLevels; ++i) {
+        const auto & level = m_levels[i];
+
+        sortRun(level.nodes, m_itemIdx, m_itemX, nullptr);
+        sortRun(level.commands, m_itemIdx, m_itemX, nullptr);
+        sortRun(level.edges, m_edgeSrc, m_edgeXmin, &m_edgeDst);
+
+        m_levelYmin[i] = level.ymin;
+        m_maxRowHeight = std::max(m_maxRowHeight, level.ymax - level.ymin);
+        m_maxEdgeAbove = std::max(m_maxEdgeAbove, level.ymin - level.eymin);
+        m_maxEdgeBelow = std::max(m_maxEdgeBelow, level.eymax - level.ymin);
+    }
+
+    // the remaining coordinates follow the sorted order
+    m_itemY.resize(m_itemIdx.size());
+    for (int k = 0; k < (int) m_itemIdx.size(); ++k) {
+        m_itemY[k] = y[m_itemIdx[k]];
+    }
+
+    const int nEdgesTotal = (int) m_edgeSrc.size();
+    m_edgeSrcX.resize(nEdgesTotal);
+    m_edgeSrcY.resize(nEdgesTotal);
+    m_edgeDstX.resize(nEdgesTotal);
+    m_edgeDstY.resize(nEdgesTotal);
+    for (int e = 0; e < nEdgesTotal; ++e) {
+        m_edgeSrcX[e] = x[m_edgeSrc[e]];
+        m_edgeSrcY[e] = y[m_edgeSrc[e]];
+        m_edgeDstX[e] = x[m_edgeDst[e]];
+        m_edgeDstY[e] = y[m_edgeDst[e]];
+    }
+
+    return true;
+}
+
+void LevelLayout::clear() {
+    m_maxRowHeight = 0.0f;
+    m_maxEdgeAbove = 0.0f;
+    m_maxEdgeBelow = 0.0f;
+
+    m_levels.clear();
+    m_levelYmin.clear();
+
+    m_itemIdx.clear();
+    m_itemX.clear();
+    m_itemY.clear();
+
+    m_edgeSrc.clear();
+    m_edgeDst.clear();
+    m_edgeXmin.clear();
+    m_edgeSrcX.clear();
+    m_edgeSrcY.clear();
+    m_edgeDstX.clear();
+    m_edgeDstY.clear();
+}
+
+LevelLayout::Range LevelLayout::getLevels(float ymin, float ymax) const {
+    const auto begin = std::lower_bound(m_levelYmin.begin(), m_levelYmin.end(), ymin - m_maxRowHeight);
+    const auto end = std::upper_bound(begin, m_levelYmin.end(), ymax);
+
+    return { int32_t(begin - m_levelYmin.begin()), int32_t(end - m_levelYmin.begin()) };
+}
+
+LevelLayout::Range LevelLayout::getEdgeLevels(float ymin, float ymax) const {
+    // the edges of a level extend from its row up to the rows of the parents, or below for unusual layouts
+    const auto begin = std::lower_bound(m_levelYmin.begin(), m_levelYmin.end(), ymin - m_maxEdgeBelow);
+    const auto end = std::upper_bound(begin, m_levelYmin.end(), ymax + m_maxEdgeAbove);
+
+    return { int32_t(begin - m_levelYmin.begin()), int32_t(end - m_levelYmin.begin()) };
+}
+
+LevelLayout::Range LevelLayout::getEdges(const Level & level, float xmin, float xmax) const {
+    const auto first = m_edgeXmin.begin() + level.edges.begin;
+    const auto last  = m_edgeXmin.begin() + level.edges.end;
+
+    const auto begin = std::lower_bound(first, last, xmin - level.edgeMaxDx);
+    const auto end = std::upper_bound(begin, last, xmax);
+
+    return { int32_t(begin - m_edgeXmin.begin()), int32_t(end - m_edgeXmin.begin()) };
+}
+
+LevelLayout::Range LevelLayout::find(const Range & run, float xmin, float xmax) const {
+    const auto first = m_itemX.begin() + run.begin;
+    const auto last  = m_itemX.begin() + run.end;
+
+    const auto begin = std::lower_bound(first, last, xmin);
+    const auto end = std::upper_bound(begin, last, xmax);
+
+    return { int32_t(begin - m_itemX.begin()), int32_t(end - m_itemX.begin()) };
+}
+
+}
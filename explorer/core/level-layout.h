@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ImVid {
+
+// Nodes bucketed by level and sorted by x, for viewport culling with binary searches
+//
+// The hierarchical layout places all nodes of a level on the same row, so the visible nodes are a contiguous
+// x-range inside each level of a contiguous band of levels. Every level holds a run of nodes, a run of
+// commands and a run of the edges that leave the level (child -> parent), sorted by their min x.
+//
+struct LevelLayout {
+public:
+    using Index = int32_t;
+
+    static constexpr int32_t kTypeCommand = 2;
+
+    struct Range {
+        int32_t begin = 0;
+        int32_t end = 0;
+    };
+
+    struct Level {
+        int32_t level = 0;
+
+        // extent of the row and of the edges that leave it
+        float ymin = 0.0f;
+        float ymax = 0.0f;
+        float eymin = 0.0f;
+        float eymax = 0.0f;
+
+        // widest edge of the level
+        float edgeMaxDx = 0.0f;
+
+        Range nodes;
+        Range commands;
+        Range edges;
+    };
+
+    LevelLayout();
+    ~LevelLayout();
+
+    // all arrays are indexed by the dense node index, parents[i] == -1 for roots
+    bool build(
+            const std::vector<float> & x,
+            const std::vector<float> & y,
+            const std::vector<int32_t> & levels,
+            const std::vector<int32_t> & types,
+            const std::vector<Index> & parents);
+
+    void clear();
+
+    int getNumLevels() const { return (int) m_levels.size(); }
+    const Level & getLevel(int i) const { return m_levels[i]; }
+
+    // levels, sorted by y, whose rows may intersect [ymin, ymax] - check Level::ymin / ymax to be exact
+    Range getLevels(float ymin, float ymax) const;
+
+    // levels whose edges may intersect [ymin, ymax] - check Level::eymin / eymax to be exact
+    Range getEdgeLevels(float ymin, float ymax) const;
+
+    // nodes / commands of a level with xmin <= x <= xmax
+    Range getNodes(const Level & level, float xmin, float xmax) const { return find(level.nodes, xmin, xmax); }
+    Range getCommands(const Level & level, float xmin, float xmax) const { return find(level.commands, xmin, xmax); }
+
+    // edges of a level whose x-extent may intersect [xmin, xmax]
+    Range getEdges(const Level & level, float xmin, float xmax) const;
+
+    Index getItem(int i) const { return m_itemIdx[i]; }
+    Index getEdgeSrc(int i) const { return m_edgeSrc[i]; }
+    Index getEdgeDst(int i) const { return m_edgeDst[i]; }
+
+    // positions in run order, for culling whole runs with the SIMD kernels
+    const float * getItemsX() const { return m_itemX.data(); }
+    const float * getItemsY() const { return m_itemY.data(); }
+
+    const float * getEdgesSrcX() const { return m_edgeSrcX.data(); }
+    const float * getEdgesSrcY() const { return m_edgeSrcY.data(); }
+    const float * getEdgesDstX() const { return m_edgeDstX.data(); }
+    const float * getEdgesDstY() const { return m_edgeDstY.data(); }
+
+private:
+    Range find(const Range & run, float xmin, float xmax) const;
+
+    float m_maxRowHeight = 0.0f;
+    float m_maxEdgeAbove = 0.0f;
+    float m_maxEdgeBelow = 0.0f;
+
+    // sorted by ymin
+    std::vector<Level> m_levels;
+    std::vector<float> m_levelYmin;
+
+    // nodes and commands in level order, each run sorted by x
+    std::vector<Index> m_itemIdx;
+    std::vector<float> m_itemX;
+    std::vector<float> m_itemY;
+
+    // edges in level order, each run sorted by min x
+    std::vector<Index> m_edgeSrc;
+    std::vector<Index> m_edgeDst;
+    std::vector<float> m_edgeXmin;
+    std::vector<float> m_edgeSrcX;
+    std::vector<float> m_edgeSrcY;
+    std::vector<float> m_edgeDstX;
+    std::vector<float> m_edgeDstY;
+};
+
+}
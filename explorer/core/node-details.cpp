@@ -0,0 +1,228 @@
+#include "core/node-details.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+namespace {
+    const char kHeader[] = "T2DD 1\n";
+
+    // reads a non-negative decimal number followed by the given separator
+    bool readNumber(const uint8_t * & p, const uint8_t * end, char sep, uint64_t & res) {
+        res = 0;
+
+        const uint8_t * begin = p;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (p - begin >= 19) return false;
+            res = 10*res + (*p - '0');
+            ++p;
+        }
+
+        if (p == begin || p == end || *p != sep) return false;
+        ++p;
+
+        return true;
+    }
+}
+
+namespace ImVid {
+
+NodeDetails::NodeDetails() {}
+
+NodeDetails::~NodeDetails() {}
+
+bool NodeDetails::init(size_t maxBytes) {
+    if (maxBytes == 0) {
+        fprintf(stderr, "Invalid node details cache size: %zu\n", maxBytes);
+        return false;
+    }
+
+    clear();
+
+    m_maxBytes = maxBytes;
+
+    return true;
+}
+
+void NodeDetails::clear() {
+    m_nBytes = 0;
+
+    m_entries.clear();
+    m_index.clear();
+
+    m_pending.clear();
+    m_loading.clear();
+
+    m_nRequests = 0;
+    m_retryAfter.clear();
+}
+
+const NodeDetails::Details * NodeDetails::get(int64_t id) {
+    auto it = m_index.find(id);
+    if (it == m_index.end()) return nullptr;
+
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+
+    return &*it->second;
+}
+
+void NodeDetails::request(int64_t id) {
+    if (id <= 0 || m_index.find(id) != m_index.end()) return;
+
+    {
+        const auto it = m_retryAfter.find(id);
+        if (it != m_retryAfter.end()) {
+            if (m_nRequests < it->second) return;
+            m_retryAfter.erase(it);
+        }
+    }
+
+    auto & ids = m_pending[getShard(id)];
+    for (const auto cur : ids) {
+        if (cur == id) return;
+    }
+
+    ids.push_back(id);
+}
+
+void NodeDetails::getRequests(std::vector<std::string> & shards) {
+    shards.clear();
+
+    ++m_nRequests;
+
+    for (const auto & [shard, ids] : m_pending) {
+        if (m_loading.insert(shard).second) {
+            shards.push_back(shard);
+        }
+    }
+}
+
+bool NodeDetails::load(const std::string & shard, const uint8_t * data, size_t n) {
+    m_loading.erase(shard);
+
+    std::vector<int64_t> ids;
+    {
+        auto it = m_pending.find(shard);
+        if (it != m_pending.end()) {
+            ids = std::move(it->second);
+            m_pending.erase(it);
+        }
+    }
+
+    std::vector<Details> records;
+    const bool res = parse(shard, data, n, records);
+
+    int64_t maxId = 0;
+    for (const auto & details : records) {
+        maxId = std::max(maxId, details.id);
+    }
+
+    // the requested records go in last, so they are the most recently used ones
+    const std::unordered_set<int64_t> requested(ids.begin(), ids.end());
+    const auto itRequested = std::stable_partition(records.begin(), records.end(), [&](const Details & details) {
+        return requested.count(details.id) == 0;
+    });
+
+    std::unordered_set<int64_t> found;
+    for (auto it = itRequested; it != records.end(); ++it) {
+        found.insert(it->id);
+    }
+
+    for (auto & details : records) {
+        insert(std::move(details));
+    }
+
+    for (const auto id : ids) {
+        if (found.count(id) > 0) continue;
+
+        // published after the shard was written - the next fetch can have it
+        if (res && id > maxId) {
+            m_retryAfter[id] = m_nRequests + kRetryRequests;
+            continue;
+        }
+
+        Details details;
+        details.id = id;
+        details.isMissing = true;
+        insert(std::move(details));
+    }
+
+    return res;
+}
+
+void NodeDetails::failed(const std::string & shard) {
+    m_loading.erase(shard);
+}
+
+bool NodeDetails::parse(const std::string & shard, const uint8_t * data, size_t n, std::vector<Details> & records) {
+    records.clear();
+
+    // shards without commands are not published
+    if (n == 0) return true;
+
+    const uint8_t * p = data;
+    const uint8_t * end = data + n;
+
+    const size_t nHeader = sizeof(kHeader) - 1;
+    if (n < nHeader || memcmp(p, kHeader, nHeader) != 0) {
+        fprintf(stderr, "Node details: shard '%s' has an invalid header\n", shard.c_str());
+        return false;
+    }
+    p += nHeader;
+
+    int nRecords = 0;
+    while (p < end) {
+        uint64_t id = 0;
+        uint64_t nCmd = 0;
+        uint64_t nInput = 0;
+        if (readNumber(p, end, ' ', id) == false ||
+            readNumber(p, end, ' ', nCmd) == false ||
+            readNumber(p, end, '\n', nInput) == false ||
+            nCmd >= (uint64_t) (end - p) || nInput >= (uint64_t) (end - p) - nCmd ||
+            p[nCmd + nInput] != '\n') {
+            fprintf(stderr, "Node details: shard '%s' is malformed after %d records\n", shard.c_str(), nRecords);
+            return false;
+        }
+
+        Details details;
+        details.id = (int64_t) id;
+        details.cmd.assign((const char *) p, nCmd);
+        details.input.assign((const char *) p + nCmd, nInput);
+        p += nCmd + nInput + 1;
+
+        records.push_back(std::move(details));
+        ++nRecords;
+    }
+
+    return true;
+}
+
+std::string NodeDetails::getShard(int64_t id) {
+    return std::to_string(id).substr(0, kPrefixLength);
+}
+
+void NodeDetails::insert(Details && details) {
+    {
+        auto it = m_index.find(details.id);
+        if (it != m_index.end()) {
+            m_nBytes -= getSize(*it->second);
+            m_entries.erase(it->second);
+            m_index.erase(it);
+        }
+    }
+
+    m_nBytes += getSize(details);
+    m_entries.push_front(std::move(details));
+    m_index[m_entries.front().id] = m_entries.begin();
+
+    // the least recently used details go first - the new entry stays even if it is larger than the cache
+    while (m_nBytes > m_maxBytes && m_entries.size() > 1) {
+        const auto it = std::prev(m_entries.end());
+        m_nBytes -= getSize(*it);
+        m_index.erase(it->id);
+        m_entries.erase(it);
+    }
+}
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace ImVid {
+
+// Details of the commands - the tweet text and the input - fetched on demand and kept in a bounded LRU cache
+//
+// The details are published by tools/details.cpp in shards of all commands whose decimal id starts with the
+// same kPrefixLength digits, so one request brings the details of many nodes that are close in time:
+//
+//   T2DD 1
+//   <id> <cmd length> <input length>
+//   <cmd bytes><input bytes>
+//   ...
+//
+// Requested ids are collected until the owner fetches their shards. All records of a loaded shard are cached,
+// the requested ones last, so that a shard larger than the cache does not evict them.
+// Ids that are not in their shard are remembered as missing, unless they are newer than the newest record - the
+// shard may predate them, so they are requested again after a while.
+//
+struct NodeDetails {
+public:
+    // must match tools/details.cpp
+    static constexpr int kPrefixLength = 6;
+
+    // getRequests() calls before an id that is newer than its shard is requested again
+    static constexpr int kRetryRequests = 120;
+
+    struct Details {
+        int64_t id = 0;
+        bool isMissing = false;
+
+        std::string cmd;
+        std::string input;
+    };
+
+    NodeDetails();
+    ~NodeDetails();
+
+    bool init(size_t maxBytes);
+    void clear();
+
+    // nullptr if not cached, otherwise marks the details as recently used
+    const Details * get(int64_t id);
+
+    // queues the shard of the id, unless the details are cached or the shard is already on its way
+    void request(int64_t id);
+
+    // the shards to fetch, which are then loading
+    void getRequests(std::vector<std::string> & shards);
+
+    // an empty shard has no commands yet - the requested ids of a shard that fails to parse are missing, so that
+    // they are not fetched over and over
+    bool load(const std::string & shard, const uint8_t * data, size_t n);
+
+    // the shard can be requested again
+    void failed(const std::string & shard);
+
+    static std::string getShard(int64_t id);
+
+    size_t getNumBytes() const { return m_nBytes; }
+    int getNumEntries() const { return (int) m_entries.size(); }
+
+private:
+    static size_t getSize(const Details & details) { return sizeof(Details) + details.cmd.size() + details.input.size(); }
+
+    bool parse(const std::string & shard, const uint8_t * data, size_t n, std::vector<Details> & records);
+    void insert(Details && details);
+
+    size_t m_maxBytes = 0;
+    size_t m_nBytes = 0;
+
+    // most recently used details are at the front
+    std::list<Details> m_entries;
+    std::unordered_map<int64_t, std::list<Details>::iterator> m_index;
+
+    // ids waiting for their shard, by shard
+    std::unordered_map<std::string, std::vector<int64_t>> m_pending;
+    std::unordered_set<std::string> m_loading;
+
+    // ids newer than their shard, by the getRequests() call after which they can be requested again
+    int64_t m_nRequests = 0;
+    std::unordered_map<int64_t, int64_t> m_retryAfter;
+};
+
+}
@@ -0,0 +1,100 @@
+#include "core/parallel-draw-list.h"
+
+#include "core/worker-pool.h"
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace ImVid {
+
+namespace {
+
+// ranges are claimed through a shared counter - the calling thread takes part too, so the draw never waits
+// for workers that are busy with other tasks (e.g. a tree rebuild)
+struct Job {
+    std::atomic<int> next { 1 };
+    std::atomic<int> nDone { 0 };
+};
+
+// the indices of src are relative to its own vertices - shift them after the vertices of the target
+void append(ImDrawList & target, const ImDrawList & src) {
+    const int nVtx = src.VtxBuffer.Size;
+    const int nIdx = src.IdxBuffer.Size;
+    if (nIdx == 0) return;
+
+    target.PrimReserve(nIdx, nVtx);
+
+    const ImDrawIdx offset = (ImDrawIdx) target._VtxCurrentIdx;
+    memcpy(target._VtxWritePtr, src.VtxBuffer.Data, nVtx*sizeof(ImDrawVert));
+    for (int i = 0; i < nIdx; ++i) {
+        target._IdxWritePtr[i] = src.IdxBuffer.Data[i] + offset;
+    }
+
+    target._VtxWritePtr += nVtx;
+    target._IdxWritePtr += nIdx;
+    target._VtxCurrentIdx += nVtx;
+}
+
+}
+
+ParallelDrawList::ParallelDrawList() {}
+
+ParallelDrawList::~ParallelDrawList() {}
+
+int ParallelDrawList::draw(WorkerPool & pool, ImDrawList & target, int n, const Callback & callback) {
+    // with 16-bit indices a range could need its own vertex offset, which a plain append cannot express
+    const int nMaxRanges = sizeof(ImDrawIdx) < 4 ? 1 : pool.getNumThreads() + 1;
+    const int nRanges = std::max(1, std::min(nMaxRanges, n/std::max(1, m_minRangeSize)));
+
+    if (nRanges == 1) {
+        callback(target, 0, n);
+        return 1;
+    }
+
+    while ((int) m_lists.size() < nRanges) {
+        m_lists.emplace_back(new ImDrawList(ImGui::GetDrawListSharedData()));
+    }
+
+    const ImVec2 clipMin = target.GetClipRectMin();
+    const ImVec2 clipMax = target.GetClipRectMax();
+    const ImTextureID texId = target._CmdHeader.TextureId;
+
+    for (int r = 1; r < nRanges; ++r) {
+        auto & list = *m_lists[r];
+        list._ResetForNewFrame();
+        list.PushClipRect(clipMin, clipMax);
+        list.PushTextureID(texId);
+    }
+
+    auto job = std::make_shared<Job>();
+    const auto run = [this, job, nRanges, n, &callback]() {
+        int r = 0;
+        while ((r = job->next++) < nRanges) {
+            callback(*m_lists[r], (int64_t) r*n/nRanges, (int64_t) (r + 1)*n/nRanges);
+            ++job->nDone;
+        }
+    };
+
+    for (int r = 1; r < nRanges; ++r) {
+        pool.submit(run);
+    }
+
+    callback(target, 0, n/nRanges);
+    run();
+
+    while (job->nDone < nRanges - 1) {
+        std::this_thread::yield();
+    }
+
+    for (int r = 1; r < nRanges; ++r) {
+        append(target, *m_lists[r]);
+    }
+
+    return nRanges;
+}
+
+}
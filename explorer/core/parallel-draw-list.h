@@ -0,0 +1,41 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct ImDrawList;
+
+namespace ImVid {
+
+struct WorkerPool;
+
+// Builds the geometry of many independent items on the worker pool
+//
+// The items [0, n) are split into contiguous ranges. The first range is drawn straight into the target,
+// the others into their own ImDrawList with the clip rect and the texture of the target. The lists are
+// appended to the target in range order, so the result is the same as drawing everything on one thread.
+//
+// The callback may only add primitives to the list it is given - no clip rect or texture changes and no
+// other ImGui calls, since those are not thread-safe.
+//
+struct ParallelDrawList {
+public:
+    using Callback = std::function<void(ImDrawList & drawList, int begin, int end)>;
+
+    ParallelDrawList();
+    ~ParallelDrawList();
+
+    // ranges are not made smaller than this, so that small batches stay on the calling thread
+    void setMinRangeSize(int n) { m_minRangeSize = n; }
+
+    // returns the number of ranges that were used
+    int draw(WorkerPool & pool, ImDrawList & target, int n, const Callback & callback);
+
+private:
+    int m_minRangeSize = 4096;
+
+    std::vector<std::unique_ptr<ImDrawList>> m_lists;
+};
+
+}
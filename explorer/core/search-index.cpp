@@ -0,0 +1,149 @@
+#include "core/search-index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <numeric>
+
+namespace {
+    // int64 ids have at most 19 decimal digits
+    const int kMaxIdDigits = 19;
+
+    std::string toLower(std::string s) {
+        for (auto & c : s) c = std::tolower((unsigned char) c);
+        return s;
+    }
+}
+
+namespace ImVid {
+
+SearchIndex::SearchIndex() {}
+
+SearchIndex::~SearchIndex() {}
+
+bool SearchIndex::build(const std::vector<std::string> & playerNames, const std::vector<int32_t> & players, const std::vector<int64_t> & ids) {
+    clear();
+
+    const int n = players.size();
+    const int nPlayers = playerNames.size();
+    if ((int) ids.size() != n) {
+        fprintf(stderr, "Invalid search index input: %d nodes, %d ids\n", n, (int) ids.size());
+        return false;
+    }
+
+    // sort the players by lower-case name
+    std::vector<int32_t> order(nPlayers);
+    std::iota(order.begin(), order.end(), 0);
+
+    m_names.resize(nPlayers);
+    for (int p = 0; p < nPlayers; ++p) {
+        m_names[p] = toLower(playerNames[p]);
+    }
+    std::sort(order.begin(), order.end(), [&](int32_t a, int32_t b) { return m_names[a] < m_names[b]; });
+
+    std::vector<int32_t> rank(nPlayers);
+    {
+        std::vector<std::string> sorted(nPlayers);
+        for (int i = 0; i < nPlayers; ++i) {
+            rank[order[i]] = i;
+            sorted[i] = std::move(m_names[order[i]]);
+        }
+        m_names = std::move(sorted);
+    }
+
+    // group the nodes by the rank of their player
+    m_nameBegin.assign(nPlayers + 1, 0);
+    for (int i = 0; i < n; ++i) {
+        if (players[i] < 0) continue;
+        if (players[i] >= nPlayers) {
+            fprintf(stderr, "Invalid player %d of node %d\n", players[i], i);
+            clear();
+            return false;
+        }
+        ++m_nameBegin[rank[players[i]] + 1];
+    }
+    for (int i = 0; i < nPlayers; ++i) {
+        m_nameBegin[i + 1] += m_nameBegin[i];
+    }
+
+    m_nameNodes.resize(m_nameBegin[nPlayers]);
+    {
+        std::vector<int32_t> pos(m_nameBegin.begin(), m_nameBegin.end() - 1);
+        for (int i = 0; i < n; ++i) {
+            if (players[i] < 0) continue;
+            m_nameNodes[pos[rank[players[i]]]++] = i;
+        }
+    }
+
+    m_ids.resize(n);
+    for (int i = 0; i < n; ++i) {
+        m_ids[i] = { ids[i], i };
+    }
+    std::sort(m_ids.begin(), m_ids.end());
+
+    return true;
+}
+
+bool SearchIndex::clear() {
+    m_names.clear();
+    m_nameBegin.clear();
+    m_nameNodes.clear();
+    m_ids.clear();
+
+    return true;
+}
+
+int SearchIndex::findName(const std::string & prefix, std::vector<Index> & res, int maxResults) const {
+    if (m_names.empty()) return 0;
+
+    const auto key = toLower(prefix);
+
+    // names that start with the prefix are contiguous and follow its lower bound
+    const auto lo = std::lower_bound(m_names.begin(), m_names.end(), key);
+    const auto hi = std::partition_point(lo, m_names.end(), [&](const std::string & name) { return name.compare(0, key.size(), key) == 0; });
+
+    const int begin = m_nameBegin[lo - m_names.begin()];
+    const int end = m_nameBegin[hi - m_names.begin()];
+
+    for (int i = begin; i < end && i - begin < maxResults; ++i) {
+        res.push_back(m_nameNodes[i]);
+    }
+
+    return end - begin;
+}
+
+int SearchIndex::findId(const std::string & prefix, std::vector<Index> & res, int maxResults) const {
+    const int len = prefix.size();
+    if (len == 0 || len > kMaxIdDigits || prefix[0] == '0') return 0;
+
+    uint64_t value = 0;
+    for (const auto c : prefix) {
+        if (c < '0' || c > '9') return 0;
+        value = 10*value + (c - '0');
+    }
+
+    int total = 0;
+    int nAdded = 0;
+
+    // for ids with nDigits digits, the prefix covers [value*10^k, (value + 1)*10^k) with k = nDigits - len
+    uint64_t scale = 1;
+    for (int nDigits = len; nDigits <= kMaxIdDigits; ++nDigits, scale *= 10) {
+        const uint64_t v0 = value*scale;
+        const uint64_t v1 = (value + 1)*scale;
+
+        if (v0 > (uint64_t) INT64_MAX) break;
+
+        const auto lo = std::lower_bound(m_ids.begin(), m_ids.end(), std::pair<int64_t, Index> { (int64_t) v0, 0 });
+        const auto hi = v1 > (uint64_t) INT64_MAX ? m_ids.end() :
+            std::lower_bound(lo, m_ids.end(), std::pair<int64_t, Index> { (int64_t) v1, 0 });
+
+        total += hi - lo;
+        for (auto it = lo; it != hi && nAdded < maxResults; ++it, ++nAdded) {
+            res.push_back(it->second);
+        }
+    }
+
+    return total;
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ImVid {
+
+// Prefix search over player names and node ids
+//
+// The names are sorted once, and the nodes of each player are stored grouped in the same order, so all
+// nodes matching a name prefix form one contiguous range. Ids are kept in a sorted array - a decimal
+// prefix maps to one numeric range per possible number of digits.
+//
+struct SearchIndex {
+public:
+    using Index = int32_t;
+
+    SearchIndex();
+    ~SearchIndex();
+
+    // players[i] is the interned player of node i (-1 for none) and playerNames[p] is the name of player p
+    bool build(const std::vector<std::string> & playerNames, const std::vector<int32_t> & players, const std::vector<int64_t> & ids);
+    bool clear();
+
+    // appends up to maxResults nodes whose player name starts with prefix (case-insensitive)
+    // returns the total number of matching nodes
+    int findName(const std::string & prefix, std::vector<Index> & res, int maxResults) const;
+
+    // appends up to maxResults nodes whose decimal id starts with prefix
+    // returns the total number of matching nodes
+    int findId(const std::string & prefix, std::vector<Index> & res, int maxResults) const;
+
+private:
+    // lower-case player names in sorted order
+    std::vector<std::string> m_names;
+
+    // the nodes of m_names[i] are m_nameNodes[m_nameBegin[i] .. m_nameBegin[i + 1])
+    std::vector<int32_t> m_nameBegin;
+    std::vector<Index> m_nameNodes;
+
+    // sorted by id
+    std::vector<std::pair<int64_t, Index>> m_ids;
+};
+
+}
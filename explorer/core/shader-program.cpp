@@ -47,6 +47,29 @@ namespace {
             FragColor = vec4(color0.xyz, aColor.w);
         })";
 
+	const char * kShaderIdRenderVertex = R"(
+        in vec3 aPos;
+
+        flat out uint aId;
+
+        void main()
+        {
+            gl_Position = vec4(aPos.x, aPos.y, 0.0, 1.0);
+            aId = uint(aPos.z + 0.5);
+        })";
+
+	const char * kShaderIdRenderFragment = R"(
+        precision mediump float;
+        precision highp int;
+
+        flat in uint aId;
+        out vec4 FragColor;
+
+        void main()
+        {
+            FragColor = vec4(float(aId & 255u), float((aId >> 8) & 255u), float((aId >> 16) & 255u), 255.0)/255.0;
+        })";
+
     bool compile(uint32_t type, const char * source, uint32_t & shader) {
         shader = glCreateShader(type);
         const GLchar* vertex_shader_with_version[2] = { g_GlslVersionString, source };
@@ -162,6 +185,10 @@ bool ShaderProgram::createLineRender() {
     return create(::kShaderLineRenderVertex, ::kShaderLineRenderFragment);
 }
 
+bool ShaderProgram::createIdRender() {
+    return create(::kShaderIdRenderVertex, ::kShaderIdRenderFragment);
+}
+
 bool ShaderProgram::setData(const char * blockName, const uint32_t uboId) {
     auto index = glGetUniformBlockIndex(program, blockName);
     glBindBufferBase(GL_UNIFORM_BUFFER, index, uboId);
@@ -391,6 +418,67 @@ bool ShaderProgram::renderPolygonFilled(
     return true;
 }
 
+bool ShaderProgram::renderRectsId(
+        const ImVid::FrameBuffer & fbo,
+        const std::vector<std::array<float, 4>> & rects) {
+    int nRects = rects.size();
+    if (nRects < 1) return false;
+
+    // the ids are passed as floats - exact up to 2^24
+    if (nRects >= (1 << 24)) {
+        fprintf(stderr, "Too many rects for id rendering: %d\n", nRects);
+        return false;
+    }
+
+    fbo.bind();
+    fbo.setViewport();
+    use(fbo.getSizeX(), fbo.getSizeY());
+
+    const GLboolean lastEnableBlend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+
+    std::vector<float> vertices(12*nRects);
+    std::vector<uint32_t> indices(6*nRects);
+    for (int i = 0; i < nRects; ++i) {
+        const float id = i + 1;
+
+        vertices[12*i +  0] = rects[i][0]; vertices[12*i +  1] = rects[i][1]; vertices[12*i +  2] = id;
+        vertices[12*i +  3] = rects[i][2]; vertices[12*i +  4] = rects[i][1]; vertices[12*i +  5] = id;
+        vertices[12*i +  6] = rects[i][2]; vertices[12*i +  7] = rects[i][3]; vertices[12*i +  8] = id;
+        vertices[12*i +  9] = rects[i][0]; vertices[12*i + 10] = rects[i][3]; vertices[12*i + 11] = id;
+
+        indices[6*i + 0] = 4*i + 0; indices[6*i + 1] = 4*i + 1; indices[6*i + 2] = 4*i + 2;
+        indices[6*i + 3] = 4*i + 0; indices[6*i + 4] = 4*i + 2; indices[6*i + 5] = 4*i + 3;
+    }
+
+    GLuint vbo;
+    GLuint ebo;
+    glGenBuffers(1, &vbo);
+    glGenBuffers(1, &ebo);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(float), vertices.data(), GL_STREAM_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size()*sizeof(indices[0]), indices.data(), GL_STREAM_DRAW);
+
+    glBindVertexArray(vaoHandle);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+    glEnableVertexAttribArray(0);
+    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    glDisableVertexAttribArray(0);
+
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ebo);
+
+    if (lastEnableBlend) glEnable(GL_BLEND);
+
+    fbo.unbind();
+
+    return true;
+}
+
 bool ShaderProgram::use(int sizeX, int sizeY) const {
     if (m_isValid) {
         glUseProgram(program);
@@ -16,6 +16,7 @@ public:
     bool free();
     bool create(const char * sourceVertex, const char * sourceFragment);
     bool createLineRender();
+    bool createIdRender();
     bool setData(const char * blockName, const uint32_t uboId);
     bool setData(const char * blockName, const UniformBuffer & ubo);
     bool setTextureId(uint32_t texId);
@@ -38,6 +39,11 @@ public:
             const std::array<float, 4> & color,
             const std::vector<std::array<float, 2>> & points);
 
+    // renders each rect { x0, y0, x1, y1 } with its index + 1 encoded as RGB color, without blending
+    bool renderRectsId(
+            const ImVid::FrameBuffer & fbo,
+            const std::vector<std::array<float, 4>> & rects);
+
     bool use(int sizeX, int sizeY) const;
 
     uint32_t getVaoHandle() const { return vaoHandle; }
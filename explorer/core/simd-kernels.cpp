@@ -0,0 +1,309 @@
+#include "core/simd-kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define IMVID_SIMD_WASM
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define IMVID_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define IMVID_SIMD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define IMVID_SIMD_NEON
+#endif
+
+namespace ImVid {
+
+namespace {
+
+// a thin layer over the intrinsics, so that the kernels are written once for all backends
+// VF - lanes of floats, VM - lanes of comparison masks
+
+#if defined(IMVID_SIMD_WASM)
+constexpr int kWidth = 4;
+constexpr const char * kBackend = "wasm-simd128";
+
+using VF = v128_t;
+using VM = v128_t;
+
+inline VF vload(const float * p) { return wasm_v128_load(p); }
+inline void vstore(float * p, VF a) { wasm_v128_store(p, a); }
+inline VF vset1(float a) { return wasm_f32x4_splat(a); }
+inline VF vsub(VF a, VF b) { return wasm_f32x4_sub(a, b); }
+inline VF vadd(VF a, VF b) { return wasm_f32x4_add(a, b); }
+inline VF vmul(VF a, VF b) { return wasm_f32x4_mul(a, b); }
+inline VF vdiv(VF a, VF b) { return wasm_f32x4_div(a, b); }
+inline VF vsqrt(VF a) { return wasm_f32x4_sqrt(a); }
+inline VF vmin(VF a, VF b) { return wasm_f32x4_pmin(a, b); }
+inline VF vmax(VF a, VF b) { return wasm_f32x4_pmax(a, b); }
+inline VM vge(VF a, VF b) { return wasm_f32x4_ge(a, b); }
+inline VM vle(VF a, VF b) { return wasm_f32x4_le(a, b); }
+inline VM vgt(VF a, VF b) { return wasm_f32x4_gt(a, b); }
+inline VM vand(VM a, VM b) { return wasm_v128_and(a, b); }
+inline VF vselect(VM m, VF a) { return wasm_v128_and(m, a); }
+inline uint32_t vbits(VM m) { return wasm_i32x4_bitmask(m); }
+#elif defined(IMVID_SIMD_AVX2)
+constexpr int kWidth = 8;
+constexpr const char * kBackend = "avx2";
+
+using VF = __m256;
+using VM = __m256;
+
+inline VF vload(const float * p) { return _mm256_loadu_ps(p); }
+inline void vstore(float * p, VF a) { _mm256_storeu_ps(p, a); }
+inline VF vset1(float a) { return _mm256_set1_ps(a); }
+inline VF vsub(VF a, VF b) { return _mm256_sub_ps(a, b); }
+inline VF vadd(VF a, VF b) { return _mm256_add_ps(a, b); }
+inline VF vmul(VF a, VF b) { return _mm256_mul_ps(a, b); }
+inline VF vdiv(VF a, VF b) { return _mm256_div_ps(a, b); }
+inline VF vsqrt(VF a) { return _mm256_sqrt_ps(a); }
+inline VF vmin(VF a, VF b) { return _mm256_min_ps(a, b); }
+inline VF vmax(VF a, VF b) { return _mm256_max_ps(a, b); }
+inline VM vge(VF a, VF b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+inline VM vle(VF a, VF b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+inline VM vgt(VF a, VF b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline VM vand(VM a, VM b) { return _mm256_and_ps(a, b); }
+inline VF vselect(VM m, VF a) { return _mm256_and_ps(m, a); }
+inline uint32_t vbits(VM m) { return _mm256_movemask_ps(m); }
+#elif defined(IMVID_SIMD_SSE2)
+constexpr int kWidth = 4;
+constexpr const char * kBackend = "sse2";
+
+using VF = __m128;
+using VM = __m128;
+
+inline VF vload(const float * p) { return _mm_loadu_ps(p); }
+inline void vstore(float * p, VF a) { _mm_storeu_ps(p, a); }
+inline VF vset1(float a) { return _mm_set1_ps(a); }
+inline VF vsub(VF a, VF b) { return _mm_sub_ps(a, b); }
+inline VF vadd(VF a, VF b) { return _mm_add_ps(a, b); }
+inline VF vmul(VF a, VF b) { return _mm_mul_ps(a, b); }
+inline VF vdiv(VF a, VF b) { return _mm_div_ps(a, b); }
+inline VF vsqrt(VF a) { return _mm_sqrt_ps(a); }
+inline VF vmin(VF a, VF b) { return _mm_min_ps(a, b); }
+inline VF vmax(VF a, VF b) { return _mm_max_ps(a, b); }
+inline VM vge(VF a, VF b) { return _mm_cmpge_ps(a, b); }
+inline VM vle(VF a, VF b) { return _mm_cmple_ps(a, b); }
+inline VM vgt(VF a, VF b) { return _mm_cmpgt_ps(a, b); }
+inline VM vand(VM a, VM b) { return _mm_and_ps(a, b); }
+inline VF vselect(VM m, VF a) { return _mm_and_ps(m, a); }
+inline uint32_t vbits(VM m) { return _mm_movemask_ps(m); }
+#elif defined(IMVID_SIMD_NEON)
+constexpr int kWidth = 4;
+constexpr const char * kBackend = "neon";
+
+using VF = float32x4_t;
+using VM = uint32x4_t;
+
+inline VF vload(const float * p) { return vld1q_f32(p); }
+inline void vstore(float * p, VF a) { vst1q_f32(p, a); }
+inline VF vset1(float a) { return vdupq_n_f32(a); }
+inline VF vsub(VF a, VF b) { return vsubq_f32(a, b); }
+inline VF vadd(VF a, VF b) { return vaddq_f32(a, b); }
+inline VF vmul(VF a, VF b) { return vmulq_f32(a, b); }
+inline VF vdiv(VF a, VF b) { return vdivq_f32(a, b); }
+inline VF vsqrt(VF a) { return vsqrtq_f32(a); }
+inline VF vmin(VF a, VF b) { return vminq_f32(a, b); }
+inline VF vmax(VF a, VF b) { return vmaxq_f32(a, b); }
+inline VM vge(VF a, VF b) { return vcgeq_f32(a, b); }
+inline VM vle(VF a, VF b) { return vcleq_f32(a, b); }
+inline VM vgt(VF a, VF b) { return vcgtq_f32(a, b); }
+inline VM vand(VM a, VM b) { return vandq_u32(a, b); }
+inline VF vselect(VM m, VF a) { return vreinterpretq_f32_u32(vandq_u32(m, vreinterpretq_u32_f32(a))); }
+inline uint32_t vbits(VM m) {
+    static const uint32_t kBits[4] = { 1, 2, 4, 8 };
+    return vaddvq_u32(vandq_u32(m, vld1q_u32(kBits)));
+}
+#else
+constexpr int kWidth = 1;
+constexpr const char * kBackend = "scalar";
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+inline int ctz(uint32_t x) { unsigned long r; _BitScanForward(&r, x); return (int) r; }
+#else
+inline int ctz(uint32_t x) { return __builtin_ctz(x); }
+#endif
+
+// appends base + k for every set bit k of the lane mask
+inline int compact(uint32_t bits, int32_t base, int32_t * res, int nRes) {
+    while (bits) {
+        res[nRes++] = base + ctz(bits);
+        bits &= bits - 1;
+    }
+
+    return nRes;
+}
+
+}
+
+const char * getSimdBackend() {
+    return kBackend;
+}
+
+int getSimdWidth() {
+    return kWidth;
+}
+
+void transformPointsScalar(int n, const float * x, const float * y, float ox, float oy, float sx, float sy, float * rx, float * ry) {
+    for (int i = 0; i < n; ++i) {
+        rx[i] = (x[i] - ox)*sx;
+        ry[i] = (y[i] - oy)*sy;
+    }
+}
+
+int cullPointsScalar(int n, const float * x, const float * y, float x0, float y0, float x1, float y1, int32_t * res) {
+    int nRes = 0;
+    for (int i = 0; i < n; ++i) {
+        if (x[i] < x0 || x[i] > x1 || y[i] < y0 || y[i] > y1) continue;
+        res[nRes++] = i;
+    }
+
+    return nRes;
+}
+
+int cullSegmentsScalar(int n, const float * xa, const float * ya, const float * xb, const float * yb, float x0, float y0, float x1, float y1, int32_t * res) {
+    int nRes = 0;
+    for (int i = 0; i < n; ++i) {
+        if (std::max(xa[i], xb[i]) < x0 || std::min(xa[i], xb[i]) > x1 ||
+            std::max(ya[i], yb[i]) < y0 || std::min(ya[i], yb[i]) > y1) {
+            continue;
+        }
+        res[nRes++] = i;
+    }
+
+    return nRes;
+}
+
+void segmentNormalsScalar(int n, const float * dx, const float * dy, float len, float * nx, float * ny) {
+    for (int i = 0; i < n; ++i) {
+        float id = std::sqrt(dx[i]*dx[i] + dy[i]*dy[i]);
+        if (id > 0.0f) {
+            id = 1.0f/id;
+        } else {
+            id = 0.0f;
+        }
+
+        nx[i] =  dy[i]*id*len;
+        ny[i] = -dx[i]*id*len;
+    }
+}
+
+#if defined(IMVID_SIMD_WASM) || defined(IMVID_SIMD_AVX2) || defined(IMVID_SIMD_SSE2) || defined(IMVID_SIMD_NEON)
+
+// the tails shorter than a full vector go through the scalar versions
+
+void transformPoints(int n, const float * x, const float * y, float ox, float oy, float sx, float sy, float * rx, float * ry) {
+    const VF vox = vset1(ox);
+    const VF voy = vset1(oy);
+    const VF vsx = vset1(sx);
+    const VF vsy = vset1(sy);
+
+    int i = 0;
+    for (; i + kWidth <= n; i += kWidth) {
+        vstore(rx + i, vmul(vsub(vload(x + i), vox), vsx));
+        vstore(ry + i, vmul(vsub(vload(y + i), voy), vsy));
+    }
+
+    transformPointsScalar(n - i, x + i, y + i, ox, oy, sx, sy, rx + i, ry + i);
+}
+
+int cullPoints(int n, const float * x, const float * y, float x0, float y0, float x1, float y1, int32_t * res) {
+    const VF vx0 = vset1(x0);
+    const VF vy0 = vset1(y0);
+    const VF vx1 = vset1(x1);
+    const VF vy1 = vset1(y1);
+
+    int nRes = 0;
+    int i = 0;
+    for (; i + kWidth <= n; i += kWidth) {
+        const VF vx = vload(x + i);
+        const VF vy = vload(y + i);
+        const VM m = vand(vand(vge(vx, vx0), vle(vx, vx1)), vand(vge(vy, vy0), vle(vy, vy1)));
+
+        nRes = compact(vbits(m), i, res, nRes);
+    }
+
+    const int nTail = cullPointsScalar(n - i, x + i, y + i, x0, y0, x1, y1, res + nRes);
+    for (int k = 0; k < nTail; ++k) res[nRes + k] += i;
+
+    return nRes + nTail;
+}
+
+int cullSegments(int n, const float * xa, const float * ya, const float * xb, const float * yb, float x0, float y0, float x1, float y1, int32_t * res) {
+    const VF vx0 = vset1(x0);
+    const VF vy0 = vset1(y0);
+    const VF vx1 = vset1(x1);
+    const VF vy1 = vset1(y1);
+
+    int nRes = 0;
+    int i = 0;
+    for (; i + kWidth <= n; i += kWidth) {
+        const VF vxa = vload(xa + i);
+        const VF vxb = vload(xb + i);
+        const VF vya = vload(ya + i);
+        const VF vyb = vload(yb + i);
+
+        const VM mx = vand(vge(vmax(vxa, vxb), vx0), vle(vmin(vxa, vxb), vx1));
+        const VM my = vand(vge(vmax(vya, vyb), vy0), vle(vmin(vya, vyb), vy1));
+
+        nRes = compact(vbits(vand(mx, my)), i, res, nRes);
+    }
+
+    const int nTail = cullSegmentsScalar(n - i, xa + i, ya + i, xb + i, yb + i, x0, y0, x1, y1, res + nRes);
+    for (int k = 0; k < nTail; ++k) res[nRes + k] += i;
+
+    return nRes + nTail;
+}
+
+void segmentNormals(int n, const float * dx, const float * dy, float len, float * nx, float * ny) {
+    const VF vzero = vset1(0.0f);
+    const VF vone = vset1(1.0f);
+    const VF vlen = vset1(len);
+
+    int i = 0;
+    for (; i + kWidth <= n; i += kWidth) {
+        const VF vdx = vload(dx + i);
+        const VF vdy = vload(dy + i);
+
+        // 1/|d| is inf for zero-length segments - masked out
+        const VF d = vsqrt(vadd(vmul(vdx, vdx), vmul(vdy, vdy)));
+        const VF id = vselect(vgt(d, vzero), vdiv(vone, d));
+
+        vstore(nx + i, vmul(vmul(vdy, id), vlen));
+        vstore(ny + i, vmul(vmul(vsub(vzero, vdx), id), vlen));
+    }
+
+    segmentNormalsScalar(n - i, dx + i, dy + i, len, nx + i, ny + i);
+}
+
+#else
+
+void transformPoints(int n, const float * x, const float * y, float ox, float oy, float sx, float sy, float * rx, float * ry) {
+    transformPointsScalar(n, x, y, ox, oy, sx, sy, rx, ry);
+}
+
+int cullPoints(int n, const float * x, const float * y, float x0, float y0, float x1, float y1, int32_t * res) {
+    return cullPointsScalar(n, x, y, x0, y0, x1, y1, res);
+}
+
+int cullSegments(int n, const float * xa, const float * ya, const float * xb, const float * yb, float x0, float y0, float x1, float y1, int32_t * res) {
+    return cullSegmentsScalar(n, xa, ya, xb, yb, x0, y0, x1, y1, res);
+}
+
+void segmentNormals(int n, const float * dx, const float * dy, float len, float * nx, float * ny) {
+    segmentNormalsScalar(n, dx, dy, len, nx, ny);
+}
+
+#endif
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ImVid {
+
+// Per-frame transform and culling kernels over SoA position arrays
+//
+// The backend is chosen at compile time: WASM SIMD (-msimd128), AVX2 (-mavx2, 8 lanes), SSE2 or NEON
+// (4 lanes), otherwise plain scalar code. The culling kernels compact the indices of the elements that
+// pass, so the caller only touches the visible ones. The *Scalar versions are always built - they are
+// the reference for the benchmark.
+//
+
+const char * getSimdBackend();
+int getSimdWidth();
+
+// r = (p - o)*s - the output can alias the input
+void transformPoints(int n, const float * x, const float * y, float ox, float oy, float sx, float sy, float * rx, float * ry);
+
+// indices of the points with x0 <= x <= x1 and y0 <= y <= y1, returns their number - res needs room for n
+int cullPoints(int n, const float * x, const float * y, float x0, float y0, float x1, float y1, int32_t * res);
+
+// indices of the segments a -> b whose bounding box intersects the rect, returns their number
+int cullSegments(int n, const float * xa, const float * ya, const float * xb, const float * yb, float x0, float y0, float x1, float y1, int32_t * res);
+
+// (dy, -dx)/|d|*len for each segment direction, 0 for zero-length segments
+// only pays off when the directions are already in SoA arrays - repacking AoS points costs more than it saves
+void segmentNormals(int n, const float * dx, const float * dy, float len, float * nx, float * ny);
+
+void transformPointsScalar(int n, const float * x, const float * y, float ox, float oy, float sx, float sy, float * rx, float * ry);
+int cullPointsScalar(int n, const float * x, const float * y, float x0, float y0, float x1, float y1, int32_t * res);
+int cullSegmentsScalar(int n, const float * xa, const float * ya, const float * xb, const float * yb, float x0, float y0, float x1, float y1, int32_t * res);
+void segmentNormalsScalar(int n, const float * dx, const float * dy, float len, float * nx, float * ny);
+
+}
@@ -0,0 +1,501 @@
+#include "core/snapshot-decoder.h"
+
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+    const char kMagic[4] = { 'T', '2', 'D', 'S' };
+
+    // sanity limits, so that a corrupt header cannot request huge allocations
+    const uint64_t kMaxStrings = 1 << 24;
+    const uint64_t kMaxStringLength = 1 << 16;
+    const uint64_t kMaxNodes = 1 << 28;
+
+    // the first version has no moves
+    const uint64_t kMinVersion = 1;
+
+    // saved records, see save()
+    const char kSavedMagic[4] = { 'T', '2', 'D', 'C' };
+    const uint32_t kSavedVersion = 1;
+
+    template <typename T>
+    void writeArray(std::vector<uint8_t> & data, const T * src, size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "plain arrays only");
+
+        const size_t offset = data.size();
+        data.resize(offset + n*sizeof(T));
+        if (n > 0) memcpy(data.data() + offset, src, n*sizeof(T));
+    }
+
+    template <typename T>
+    bool readArray(const uint8_t * & p, const uint8_t * end, T * dst, size_t n) {
+        if ((size_t) (end - p) < n*sizeof(T)) return false;
+
+        if (n > 0) memcpy(dst, p, n*sizeof(T));
+        p += n*sizeof(T);
+
+        return true;
+    }
+
+    // returns the number of bytes read, 0 if the input ends before the varint does and -1 if it is too long
+    int readVarint(const uint8_t * p, const uint8_t * end, uint64_t & v) {
+        v = 0;
+        for (int i = 0; i < 10; ++i) {
+            if (p + i >= end) return 0;
+
+            v |= uint64_t(p[i] & 0x7f) << (7*i);
+            if ((p[i] & 0x80) == 0) return i + 1;
+        }
+
+        return -1;
+    }
+
+    int64_t unzigzag(uint64_t v) {
+        return (int64_t) ((v >> 1) ^ (~(v & 1) + 1));
+    }
+
+    // reads consecutive varints - stops at the first one that is incomplete or malformed
+    struct Reader {
+        const uint8_t * p;
+        const uint8_t * end;
+
+        bool isMalformed = false;
+
+        bool read(uint64_t & v) {
+            const int n = readVarint(p, end, v);
+            if (n < 0) isMalformed = true;
+            if (n <= 0) return false;
+
+            p += n;
+            return true;
+        }
+    };
+}
+
+namespace ImVid {
+
+SnapshotDecoder::SnapshotDecoder() {}
+
+SnapshotDecoder::~SnapshotDecoder() {}
+
+void SnapshotDecoder::reset(Callback && callback, MoveCallback && moveCallback) {
+    m_step = EStep::Magic;
+    m_callback = std::move(callback);
+    m_moveCallback = std::move(moveCallback);
+
+    m_buffer.clear();
+    m_pos = 0;
+
+    m_version = 0;
+
+    m_nStrings = 0;
+    m_pool.clear();
+    m_poolIndex.clear();
+    m_strings.clear();
+
+    m_segmentBegin = 0;
+    m_nNodes = 0;
+    m_nMoves = 0;
+    m_nMovesDecoded = 0;
+    m_lastMove = -1;
+    m_nExternalParents = 0;
+    m_ids.clear();
+    m_parents.clear();
+    m_usernames.clear();
+    m_types.clear();
+    m_levels.clear();
+    m_frames.clear();
+    m_x.clear();
+    m_y.clear();
+}
+
+bool SnapshotDecoder::feed(const uint8_t * data, size_t n) {
+    if (m_step == EStep::Failed) return false;
+
+    // drop the consumed bytes once they are the larger part of the buffer
+    if (m_pos > 0 && 2*m_pos >= m_buffer.size()) {
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + m_pos);
+        m_pos = 0;
+    }
+
+    m_buffer.insert(m_buffer.end(), data, data + n);
+
+    while (true) {
+        bool isParsed = false;
+        switch (m_step) {
+            case EStep::Magic:
+            case EStep::Version:
+            case EStep::NumStrings:
+            case EStep::NumNodes:
+            case EStep::NumMoves:
+                isParsed = parseHeader();
+                break;
+            case EStep::Strings:
+                isParsed = parseString();
+                break;
+            case EStep::Nodes:
+                isParsed = parseNode();
+                break;
+            case EStep::Moves:
+                isParsed = parseMove();
+                break;
+            case EStep::Done:
+            case EStep::Failed:
+                break;
+        }
+
+        if (isParsed == false) break;
+    }
+
+    return m_step != EStep::Failed;
+}
+
+bool SnapshotDecoder::finish() {
+    if (m_step == EStep::Failed) return false;
+
+    if (m_step != EStep::Done) {
+        return fail("unexpected end of data");
+    }
+
+    if (m_pos != m_buffer.size()) {
+        return fail("trailing data");
+    }
+
+    return true;
+}
+
+bool SnapshotDecoder::beginSegment() {
+    if (m_step != EStep::Done) {
+        return fail("previous segment is not complete");
+    }
+
+    m_step = EStep::Magic;
+
+    m_buffer.clear();
+    m_pos = 0;
+
+    m_version = 0;
+
+    m_nStrings = 0;
+    m_strings.clear();
+
+    m_segmentBegin = (int) m_ids.size();
+    m_nNodes = 0;
+    m_nMoves = 0;
+    m_nMovesDecoded = 0;
+    m_lastMove = -1;
+
+    return true;
+}
+
+bool SnapshotDecoder::save(std::vector<uint8_t> & data) const {
+    if (m_step != EStep::Done) {
+        fprintf(stderr, "Snapshot: cannot save in the middle of a segment\n");
+        return false;
+    }
+
+    if (m_nExternalParents > 0) {
+        fprintf(stderr, "Snapshot: cannot save records with external parents\n");
+        return false;
+    }
+
+    data.clear();
+
+    const uint32_t nStrings = m_pool.size();
+    const uint32_t n = m_ids.size();
+
+    writeArray(data, kSavedMagic, sizeof(kSavedMagic));
+    writeArray(data, &kSavedVersion, 1);
+
+    // string offsets, then the characters
+    writeArray(data, &nStrings, 1);
+    uint32_t offset = 0;
+    for (const auto & str : m_pool) {
+        writeArray(data, &offset, 1);
+        offset += str.size();
+    }
+    writeArray(data, &offset, 1);
+    for (const auto & str : m_pool) {
+        writeArray(data, str.data(), str.size());
+    }
+
+    writeArray(data, &n, 1);
+    writeArray(data, m_ids.data(), n);
+    writeArray(data, m_parents.data(), n);
+    writeArray(data, m_usernames.data(), n);
+    writeArray(data, m_types.data(), n);
+    writeArray(data, m_levels.data(), n);
+    writeArray(data, m_frames.data(), n);
+    writeArray(data, m_x.data(), n);
+    writeArray(data, m_y.data(), n);
+
+    return true;
+}
+
+bool SnapshotDecoder::restore(const uint8_t * data, size_t n) {
+    auto callback = std::move(m_callback);
+    auto moveCallback = std::move(m_moveCallback);
+    reset(std::move(callback), std::move(moveCallback));
+
+    const uint8_t * p = data;
+    const uint8_t * end = data + n;
+
+    char magic[4];
+    uint32_t version = 0;
+    if (readArray(p, end, magic, 4) == false || memcmp(magic, kSavedMagic, 4) != 0 ||
+        readArray(p, end, &version, 1) == false || version != kSavedVersion) {
+        return fail("not a saved snapshot");
+    }
+
+    uint32_t nStrings = 0;
+    if (readArray(p, end, &nStrings, 1) == false || nStrings > kMaxStrings) return fail("invalid saved strings");
+
+    std::vector<uint32_t> offsets(nStrings + 1);
+    if (readArray(p, end, offsets.data(), nStrings + 1) == false) return fail("invalid saved strings");
+    if ((size_t) (end - p) < offsets[nStrings]) return fail("invalid saved strings");
+
+    m_pool.resize(nStrings);
+    for (uint32_t i = 0; i < nStrings; ++i) {
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > offsets[nStrings]) return fail("invalid saved strings");
+
+        m_pool[i].assign((const char *) p + offsets[i], offsets[i + 1] - offsets[i]);
+        m_poolIndex[m_pool[i]] = i;
+    }
+    p += offsets[nStrings];
+
+    uint32_t nRecords = 0;
+    if (readArray(p, end, &nRecords, 1) == false || nRecords > kMaxNodes) return fail("invalid saved records");
+
+    m_ids.resize(nRecords);
+    m_parents.resize(nRecords);
+    m_usernames.resize(nRecords);
+    m_types.resize(nRecords);
+    m_levels.resize(nRecords);
+    m_frames.resize(nRecords);
+    m_x.resize(nRecords);
+    m_y.resize(nRecords);
+
+    if (readArray(p, end, m_ids.data(), nRecords) == false ||
+        readArray(p, end, m_parents.data(), nRecords) == false ||
+        readArray(p, end, m_usernames.data(), nRecords) == false ||
+        readArray(p, end, m_types.data(), nRecords) == false ||
+        readArray(p, end, m_levels.data(), nRecords) == false ||
+        readArray(p, end, m_frames.data(), nRecords) == false ||
+        readArray(p, end, m_x.data(), nRecords) == false ||
+        readArray(p, end, m_y.data(), nRecords) == false ||
+        p != end) {
+        return fail("invalid saved records");
+    }
+
+    for (uint32_t i = 0; i < nRecords; ++i) {
+        if (m_parents[i] >= (int32_t) i || m_usernames[i] < 0 || m_usernames[i] >= (int32_t) nStrings) {
+            return fail("invalid saved records");
+        }
+    }
+
+    // the saved records behave like a fully decoded segment
+    m_segmentBegin = 0;
+    m_nNodes = nRecords;
+    m_step = EStep::Done;
+
+    if (m_callback) {
+        for (uint32_t i = 0; i < nRecords; ++i) {
+            const int32_t parent = m_parents[i];
+            m_callback({
+                (int32_t) i, m_ids[i], parent >= 0 ? m_ids[parent] : 0, &m_pool[m_usernames[i]],
+                m_levels[i], m_types[i], m_frames[i], m_x[i], m_y[i],
+            });
+        }
+    }
+
+    return true;
+}
+
+bool SnapshotDecoder::fail(const char * msg) {
+    fprintf(stderr, "Snapshot: %s (%d / %d nodes decoded)\n", msg, getNumNodesDecoded(), getNumNodes());
+    m_step = EStep::Failed;
+
+    return false;
+}
+
+bool SnapshotDecoder::parseHeader() {
+    Reader r { m_buffer.data() + m_pos, m_buffer.data() + m_buffer.size() };
+
+    uint64_t v = 0;
+    switch (m_step) {
+        case EStep::Magic:
+            {
+                if (r.end - r.p < (int) sizeof(kMagic)) return false;
+                if (memcmp(r.p, kMagic, sizeof(kMagic)) != 0) return fail("not a snapshot");
+
+                r.p += sizeof(kMagic);
+                m_step = EStep::Version;
+            }
+            break;
+        case EStep::Version:
+            {
+                if (r.read(v) == false) return r.isMalformed ? fail("malformed version") : false;
+                if (v < kMinVersion || v > kSnapshotVersion) return fail("unsupported version");
+
+                m_version = v;
+                m_step = EStep::NumStrings;
+            }
+            break;
+        case EStep::NumStrings:
+            {
+                if (r.read(v) == false) return r.isMalformed ? fail("malformed string count") : false;
+                if (v > kMaxStrings) return fail("too many strings");
+
+                m_nStrings = (int) v;
+                m_strings.reserve(m_nStrings);
+                m_step = m_nStrings > 0 ? EStep::Strings : EStep::NumNodes;
+            }
+            break;
+        case EStep::NumNodes:
+            {
+                if (r.read(v) == false) return r.isMalformed ? fail("malformed node count") : false;
+                if (v + m_segmentBegin > kMaxNodes) return fail("too many nodes");
+
+                m_nNodes = (int) v;
+                m_ids.reserve(m_segmentBegin + m_nNodes);
+                m_parents.reserve(m_segmentBegin + m_nNodes);
+                m_usernames.reserve(m_segmentBegin + m_nNodes);
+                m_types.reserve(m_segmentBegin + m_nNodes);
+                m_levels.reserve(m_segmentBegin + m_nNodes);
+                m_frames.reserve(m_segmentBegin + m_nNodes);
+                m_x.reserve(m_segmentBegin + m_nNodes);
+                m_y.reserve(m_segmentBegin + m_nNodes);
+                m_step = m_nNodes > 0 ? EStep::Nodes : getStepAfterNodes();
+            }
+            break;
+        case EStep::NumMoves:
+            {
+                if (r.read(v) == false) return r.isMalformed ? fail("malformed move count") : false;
+                if (v > m_ids.size()) return fail("too many moves");
+
+                m_nMoves = (int) v;
+                m_step = m_nMoves > 0 ? EStep::Moves : EStep::Done;
+            }
+            break;
+        default:
+            return false;
+    }
+
+    m_pos = r.p - m_buffer.data();
+
+    return true;
+}
+
+bool SnapshotDecoder::parseString() {
+    Reader r { m_buffer.data() + m_pos, m_buffer.data() + m_buffer.size() };
+
+    uint64_t len = 0;
+    if (r.read(len) == false) return r.isMalformed ? fail("malformed string length") : false;
+    if (len > kMaxStringLength) return fail("string too long");
+    if ((uint64_t) (r.end - r.p) < len) return false;
+
+    std::string str((const char *) r.p, (size_t) len);
+    r.p += len;
+
+    const auto it = m_poolIndex.find(str);
+    if (it != m_poolIndex.end()) {
+        m_strings.push_back(it->second);
+    } else {
+        m_strings.push_back((int32_t) m_pool.size());
+        m_poolIndex[str] = (int32_t) m_pool.size();
+        m_pool.push_back(std::move(str));
+    }
+
+    m_pos = r.p - m_buffer.data();
+
+    if ((int) m_strings.size() == m_nStrings) {
+        m_step = EStep::NumNodes;
+    }
+
+    return true;
+}
+
+bool SnapshotDecoder::parseNode() {
+    Reader r { m_buffer.data() + m_pos, m_buffer.data() + m_buffer.size() };
+
+    // the external parent of version 3 follows the parent step
+    uint64_t v[7];
+    uint64_t external = 0;
+    for (int k = 0; k < 7; ++k) {
+        if (r.read(v[k]) == false) return r.isMalformed ? fail("malformed node") : false;
+
+        if (k == 1 && v[1] == 0 && m_version >= 3) {
+            if (r.read(external) == false) return r.isMalformed ? fail("malformed node") : false;
+        }
+    }
+
+    const int i = (int) m_ids.size();
+
+    const uint64_t parentDelta = v[1];
+    if (parentDelta > (uint64_t) i) return fail("invalid parent");
+    if (v[3] >= m_strings.size()) return fail("invalid username");
+
+    const int p = parentDelta > 0 ? i - (int) parentDelta : -1;
+
+    Node node;
+    node.index = i;
+    node.id = (i > 0 ? m_ids.back() : 0) + unzigzag(v[0]);
+    node.parentId = p >= 0 ? m_ids[p] : external > 0 ? node.id - unzigzag(external) : 0;
+
+    if (external > 0) ++m_nExternalParents;
+    node.username = &m_pool[m_strings[v[3]]];
+    node.level = int((p >= 0 ? m_levels[p] : -1) + 1 + unzigzag(v[2] >> 2));
+    node.type = int(v[2] & 3);
+    node.frames = int((p >= 0 ? m_frames[p] : 0) + unzigzag(v[4]));
+    node.x = int((p >= 0 ? m_x[p] : 0) + unzigzag(v[5]));
+    node.y = int((p >= 0 ? m_y[p] : 0) + unzigzag(v[6]));
+
+    m_ids.push_back(node.id);
+    m_parents.push_back(p);
+    m_usernames.push_back(m_strings[v[3]]);
+    m_types.push_back((uint8_t) node.type);
+    m_levels.push_back(node.level);
+    m_frames.push_back(node.frames);
+    m_x.push_back(node.x);
+    m_y.push_back(node.y);
+
+    m_pos = r.p - m_buffer.data();
+
+    if (m_callback) m_callback(node);
+
+    if ((int) m_ids.size() == m_segmentBegin + m_nNodes) {
+        m_step = getStepAfterNodes();
+    }
+
+    return true;
+}
+
+bool SnapshotDecoder::parseMove() {
+    Reader r { m_buffer.data() + m_pos, m_buffer.data() + m_buffer.size() };
+
+    uint64_t v[3];
+    for (auto & cur : v) {
+        if (r.read(cur) == false) return r.isMalformed ? fail("malformed move") : false;
+    }
+
+    if (v[0] >= (uint64_t) ((int) m_ids.size() - (m_lastMove + 1))) return fail("invalid move");
+
+    const int i = m_lastMove + 1 + (int) v[0];
+
+    m_x[i] += (int32_t) unzigzag(v[1]);
+    m_y[i] += (int32_t) unzigzag(v[2]);
+    m_lastMove = i;
+
+    m_pos = r.p - m_buffer.data();
+
+    if (m_moveCallback) m_moveCallback({ i, m_ids[i], m_x[i], m_y[i] });
+
+    if (++m_nMovesDecoded == m_nMoves) {
+        m_step = EStep::Done;
+    }
+
+    return true;
+}
+
+}
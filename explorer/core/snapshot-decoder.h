@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ImVid {
+
+// Streaming decoder of the compact tree snapshot written by layout/vis-network/snapshot.js
+//
+// All integers are LEB128 varints, signed values are zigzag encoded. The records are ordered by id, except
+// that a parent always comes before its children, so ids and most fields are stored as small deltas:
+//
+//   "T2DS"                      magic
+//   version                     1, 2 or 3
+//   nStrings                    username table of the segment, most frequent first
+//     len, bytes[len]
+//   nNodes
+//     zigzag(id - prev id)      the id of the previous record, 0 for the first one
+//     parent                    0 - no parent, else the parent is the record parent steps back
+//     [zigzag(id - parent id)]  version 3 only, if parent is 0 - a parent outside of the snapshot, 0 for none
+//     zigzag(level - (parent level + 1))*4 + type
+//     username                  index in the string table
+//     zigzag(frames - parent frames)
+//     zigzag(x - parent x)      positions are integers, relative to (0, 0) without a parent
+//     zigzag(y - parent y)
+//   nMoves                      version 2 only - new positions of earlier records
+//     index - prev index - 1    record index, increasing, prev index is -1 for the first one
+//     zigzag(x - current x)
+//     zigzag(y - current y)
+//
+// A published tree is a base segment followed by append-only delta segments. The records of all segments
+// share one index space, so the records and moves of a delta refer to the earlier segments like to their own.
+//
+// A spatial chunk of a large tree is a single segment, whose records can have their parent in another chunk.
+// The fields of such a record are relative to (0, 0) like those of a root.
+//
+// The input can be fed in chunks of any size as it arrives - each complete record is reported through the
+// callbacks right away.
+//
+// The decoded records can be saved as plain arrays and restored later without decoding the segments again,
+// e.g. from a browser cache. After a restore, further delta segments are fed as usual.
+//
+struct SnapshotDecoder {
+public:
+    static constexpr uint32_t kSnapshotVersion = 3;
+
+    struct Node {
+        int32_t index; // record index over all segments
+        int64_t id;
+        int64_t parentId; // 0 - no parent, can be outside of the decoded records
+        const std::string * username;
+        int level;
+        int type;
+        int frames;
+        int x;
+        int y;
+    };
+
+    struct Move {
+        int32_t index;
+        int64_t id;
+        int x;
+        int y;
+    };
+
+    using Callback = std::function<void(const Node & node)>;
+    using MoveCallback = std::function<void(const Move & move)>;
+
+    SnapshotDecoder();
+    ~SnapshotDecoder();
+
+    void reset(Callback && callback, MoveCallback && moveCallback);
+
+    // returns false on malformed input - the decoder then rejects everything until reset
+    bool feed(const uint8_t * data, size_t n);
+
+    // true if the whole segment has been decoded and nothing follows it
+    bool finish();
+
+    // starts the next segment of the same tree - keeps the decoded records
+    bool beginSegment();
+
+    // the records decoded so far - only between segments and without parents outside of the records
+    bool save(std::vector<uint8_t> & data) const;
+
+    // replaces the state with saved records and reports them through the callback
+    bool restore(const uint8_t * data, size_t n);
+
+    int getNumNodes() const { return m_segmentBegin + m_nNodes; }
+    int getNumNodesDecoded() const { return (int) m_ids.size(); }
+
+private:
+    enum class EStep {
+        Magic,
+        Version,
+        NumStrings,
+        Strings,
+        NumNodes,
+        Nodes,
+        NumMoves,
+        Moves,
+        Done,
+        Failed,
+    };
+
+    bool fail(const char * msg);
+
+    EStep getStepAfterNodes() const { return m_version >= 2 ? EStep::NumMoves : EStep::Done; }
+
+    // each parses one item from m_buffer at m_pos - returns false if more input is needed
+    bool parseHeader();
+    bool parseString();
+    bool parseNode();
+    bool parseMove();
+
+    EStep m_step = EStep::Magic;
+
+    Callback m_callback;
+    MoveCallback m_moveCallback;
+
+    std::vector<uint8_t> m_buffer;
+    size_t m_pos = 0;
+
+    uint64_t m_version = 0;
+
+    int m_nStrings = 0;
+
+    // strings of all segments, each stored once - m_strings maps the table of the current segment into it
+    std::vector<std::string> m_pool;
+    std::unordered_map<std::string, int32_t> m_poolIndex;
+    std::vector<int32_t> m_strings;
+
+    // decoded fields of all records, the deltas refer to them
+    int m_segmentBegin = 0;
+    int m_nNodes = 0;
+    int m_nMoves = 0;
+    int m_nMovesDecoded = 0;
+    int32_t m_lastMove = -1;
+    int m_nExternalParents = 0;
+    std::vector<int64_t> m_ids;
+    std::vector<int32_t> m_parents;
+    std::vector<int32_t> m_usernames;
+    std::vector<uint8_t> m_types;
+    std::vector<int32_t> m_levels;
+    std::vector<int32_t> m_frames;
+    std::vector<int32_t> m_x;
+    std::vector<int32_t> m_y;
+};
+
+}
@@ -0,0 +1,88 @@
+#include "core/space-filling-curve.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace ImVid {
+
+namespace {
+
+// 0b0000abcd -> 0b0a0b0c0d
+uint32_t spreadBits(uint32_t v) {
+    v &= 0x0000ffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+
+    return v;
+}
+
+}
+
+uint32_t getMortonKey(uint32_t x, uint32_t y) {
+    return spreadBits(x) | (spreadBits(y) << 1);
+}
+
+// the classic iterative xy -> d conversion, one quadrant per step from the coarsest level
+uint32_t getHilbertKey(uint32_t x, uint32_t y) {
+    const uint32_t n = 1u << kCurveBits;
+
+    uint32_t d = 0;
+    for (uint32_t s = n/2; s > 0; s /= 2) {
+        const uint32_t rx = (x & s) > 0;
+        const uint32_t ry = (y & s) > 0;
+        d += s*s*((3*rx) ^ ry);
+
+        // rotate the quadrant
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+
+    return d;
+}
+
+bool getCurveOrder(ECurve curve, const std::vector<float> & x, const std::vector<float> & y, std::vector<int32_t> & order) {
+    const int n = (int) x.size();
+    if ((int) y.size() != n) {
+        fprintf(stderr, "Curve order: inconsistent input sizes\n");
+        return false;
+    }
+
+    order.resize(n);
+    for (int i = 0; i < n; ++i) order[i] = i;
+    if (n == 0) return true;
+
+    float xmin = x[0], xmax = x[0];
+    float ymin = y[0], ymax = y[0];
+    for (int i = 1; i < n; ++i) {
+        xmin = std::min(xmin, x[i]);
+        xmax = std::max(xmax, x[i]);
+        ymin = std::min(ymin, y[i]);
+        ymax = std::max(ymax, y[i]);
+    }
+
+    // the same scale on both axes, so that the cells are square
+    const float kMaxCell = float((1u << kCurveBits) - 1);
+    const float extent = std::max(xmax - xmin, ymax - ymin);
+    const float scale = extent > 0.0f ? kMaxCell/extent : 0.0f;
+
+    std::vector<uint32_t> keys(n);
+    for (int i = 0; i < n; ++i) {
+        const uint32_t qx = (uint32_t) std::min(kMaxCell, std::floor((x[i] - xmin)*scale));
+        const uint32_t qy = (uint32_t) std::min(kMaxCell, std::floor((y[i] - ymin)*scale));
+        keys[i] = curve == ECurve::Hilbert ? getHilbertKey(qx, qy) : getMortonKey(qx, qy);
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&](int32_t a, int32_t b) { return keys[a] < keys[b]; });
+
+    return true;
+}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ImVid {
+
+// Space-filling curve keys for ordering 2D points so that neighbours in space are neighbours in memory
+//
+// The coordinates are quantized to a square grid of 2^kCurveBits cells per axis over the bounding box of the
+// points. Hilbert order keeps more of the neighbours together than Morton order, at the cost of a few more
+// operations per key.
+//
+
+enum class ECurve {
+    Morton,
+    Hilbert,
+};
+
+constexpr int kCurveBits = 16;
+
+uint32_t getMortonKey(uint32_t x, uint32_t y);
+uint32_t getHilbertKey(uint32_t x, uint32_t y);
+
+// permutation of [0, n) that sorts the points along the curve - ties keep their original order
+bool getCurveOrder(ECurve curve, const std::vector<float> & x, const std::vector<float> & y, std::vector<int32_t> & order);
+
+}
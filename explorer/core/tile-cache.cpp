@@ -0,0 +1,91 @@
+#include "core/tile-cache.h"
+
+#include "core/frame-buffer.h"
+
+#include <cstdio>
+#include <iterator>
+
+namespace ImVid {
+
+TileCache::TileCache() {}
+
+TileCache::~TileCache() {}
+
+bool TileCache::init(int tileSize, int maxTiles) {
+    if (tileSize <= 0 || maxTiles <= 0) {
+        fprintf(stderr, "Invalid tile cache parameters: %d %d\n", tileSize, maxTiles);
+        return false;
+    }
+
+    clear();
+
+    m_tileSize = tileSize;
+    m_maxTiles = maxTiles;
+
+    return true;
+}
+
+bool TileCache::clear() {
+    m_index.clear();
+    m_tiles.clear();
+
+    return true;
+}
+
+bool TileCache::setMaxTiles(int maxTiles) {
+    if (maxTiles <= 0) {
+        fprintf(stderr, "Invalid tile cache size: %d\n", maxTiles);
+        return false;
+    }
+
+    m_maxTiles = maxTiles;
+
+    while ((int) m_tiles.size() > m_maxTiles) {
+        m_index.erase(m_tiles.back().key);
+        m_tiles.pop_back();
+    }
+
+    return true;
+}
+
+const FrameBuffer * TileCache::get(const Key & key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) return nullptr;
+
+    m_tiles.splice(m_tiles.begin(), m_tiles, it->second);
+
+    return it->second->fbo.get();
+}
+
+FrameBuffer * TileCache::insert(const Key & key) {
+    {
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_tiles.splice(m_tiles.begin(), m_tiles, it->second);
+            return it->second->fbo.get();
+        }
+    }
+
+    if ((int) m_tiles.size() >= m_maxTiles) {
+        // recycle the least recently used tile
+        auto it = std::prev(m_tiles.end());
+        m_index.erase(it->key);
+        m_tiles.splice(m_tiles.begin(), m_tiles, it);
+    } else {
+        m_tiles.push_front({ key, std::make_unique<FrameBuffer>() });
+    }
+
+    auto & tile = m_tiles.front();
+    tile.key = key;
+    m_index[key] = m_tiles.begin();
+
+    if (tile.fbo->isAllocated() == false) {
+        if (tile.fbo->create(m_tileSize, m_tileSize) == false) {
+            fprintf(stderr, "Failed to create tile frame buffer\n");
+        }
+    }
+
+    return tile.fbo.get();
+}
+
+}
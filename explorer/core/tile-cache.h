@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+
+namespace ImVid {
+struct FrameBuffer;
+
+// LRU cache of square frame buffers, addressed by (level, x, y)
+struct TileCache {
+public:
+    struct Key {
+        int32_t level;
+        int32_t x;
+        int32_t y;
+
+        bool operator<(const Key & other) const {
+            if (level != other.level) return level < other.level;
+            if (x != other.x) return x < other.x;
+            return y < other.y;
+        }
+    };
+
+    TileCache();
+    ~TileCache();
+
+    bool init(int tileSize, int maxTiles);
+    bool clear();
+
+    // keeps the most recently used tiles that fit
+    bool setMaxTiles(int maxTiles);
+
+    // returns nullptr if the tile is not cached, otherwise marks it as recently used
+    const FrameBuffer * get(const Key & key);
+
+    // returns a frame buffer for the tile, recycling the least recently used one if the cache is full
+    // the contents of the returned frame buffer are undefined
+    FrameBuffer * insert(const Key & key);
+
+    int getTileSize() const { return m_tileSize; }
+    int getMaxTiles() const { return m_maxTiles; }
+    int getNumTiles() const { return (int) m_tiles.size(); }
+
+private:
+    struct Tile {
+        Key key;
+        std::unique_ptr<FrameBuffer> fbo;
+    };
+
+    int m_tileSize = 512;
+    int m_maxTiles = 32;
+
+    // most recently used tiles are at the front
+    std::list<Tile> m_tiles;
+    std::map<Key, std::list<Tile>::iterator> m_index;
+};
+
+}
@@ -0,0 +1,147 @@
+#include "core/tree-aggregates.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+namespace {
+    // appending is O(depth) per new node - recompute everything when a large part of the tree is new
+    const int kMaxAppendFraction = 16;
+    const int kMinAppendCount = 64;
+}
+
+namespace ImVid {
+
+TreeAggregates::TreeAggregates() {}
+
+TreeAggregates::~TreeAggregates() {}
+
+bool TreeAggregates::update(const TreeIndex & tree, const std::vector<int32_t> & players, const std::vector<int32_t> & frames) {
+    const int n = tree.size();
+    if ((int) players.size() != n || (int) frames.size() != n) {
+        fprintf(stderr, "Invalid tree aggregates input: %d nodes, %d players, %d frames\n", n, (int) players.size(), (int) frames.size());
+        return false;
+    }
+
+    const int n0 = size();
+    bool isAppend = n0 > 0 && n >= n0 && n - n0 <= std::max(kMinAppendCount, n/kMaxAppendFraction);
+    for (int i = 0; isAppend && i < n0; ++i) {
+        isAppend = m_parents[i] == tree.getParent(i);
+    }
+
+    if (isAppend) {
+        return append(tree, players, frames);
+    }
+
+    return build(tree, players, frames);
+}
+
+bool TreeAggregates::clear() {
+    m_stats.clear();
+    m_parents.clear();
+    m_playerNodes.clear();
+
+    return true;
+}
+
+bool TreeAggregates::build(const TreeIndex & tree, const std::vector<int32_t> & players, const std::vector<int32_t> & frames) {
+    clear();
+
+    const int n = tree.size();
+
+    m_stats.resize(n);
+    m_parents.resize(n);
+    for (int i = 0; i < n; ++i) {
+        auto & s = m_stats[i];
+        s.nNodes = 1;
+        s.maxDepth = tree.getDepth(i);
+        s.maxFrames = frames[i];
+
+        m_parents[i] = tree.getParent(i);
+
+        if (players[i] >= 0) {
+            if (players[i] >= (int) m_playerNodes.size()) m_playerNodes.resize(players[i] + 1);
+            m_playerNodes[players[i]].push_back(i);
+        }
+    }
+
+    // distinct players: +1 at each node of a player and -1 at the LCA of each pair of its nodes that
+    // are consecutive in Euler tour order. The subtree sums then count every player exactly once.
+    for (auto & nodes : m_playerNodes) {
+        std::sort(nodes.begin(), nodes.end(), [&](Index a, Index b) { return tree.getEnter(a) < tree.getEnter(b); });
+        for (int j = 0; j < (int) nodes.size(); ++j) {
+            m_stats[nodes[j]].nPlayers += 1;
+            if (j > 0) {
+                const auto lca = tree.getLCA(nodes[j - 1], nodes[j]);
+                if (lca != TreeIndex::kInvalid) m_stats[lca].nPlayers -= 1;
+            }
+        }
+    }
+
+    // post-order: children are visited before their parents in reverse Euler tour order
+    const auto & order = tree.getOrder();
+    for (int j = n - 1; j >= 0; --j) {
+        const auto v = order[j];
+        const auto p = tree.getParent(v);
+        if (p == v) continue;
+
+        const auto & s = m_stats[v];
+        auto & sp = m_stats[p];
+        sp.nNodes += s.nNodes;
+        sp.maxDepth = std::max(sp.maxDepth, s.maxDepth);
+        sp.nPlayers += s.nPlayers;
+        sp.maxFrames = std::max(sp.maxFrames, s.maxFrames);
+    }
+
+    return true;
+}
+
+bool TreeAggregates::append(const TreeIndex & tree, const std::vector<int32_t> & players, const std::vector<int32_t> & frames) {
+    const int n0 = size();
+    const int n = tree.size();
+
+    m_stats.resize(n);
+    m_parents.resize(n);
+
+    // the new nodes are inserted one by one, so they can be in any order (e.g. a new parent after its child)
+    for (int v = n0; v < n; ++v) {
+        m_parents[v] = tree.getParent(v);
+
+        const int depth = tree.getDepth(v);
+        const int player = players[v];
+
+        // the player is already counted in the subtrees of the common ancestors with its other nodes
+        int depthCounted = -1;
+        if (player >= 0) {
+            if (player >= (int) m_playerNodes.size()) m_playerNodes.resize(player + 1);
+            auto & nodes = m_playerNodes[player];
+
+            // the deepest common ancestor with the other nodes is the one with the neighbours in Euler tour order
+            const auto it = std::lower_bound(nodes.begin(), nodes.end(), v, [&](Index a, Index b) { return tree.getEnter(a) < tree.getEnter(b); });
+            if (it != nodes.end()) {
+                const auto lca = tree.getLCA(v, *it);
+                if (lca != TreeIndex::kInvalid) depthCounted = std::max(depthCounted, tree.getDepth(lca));
+            }
+            if (it != nodes.begin()) {
+                const auto lca = tree.getLCA(v, *std::prev(it));
+                if (lca != TreeIndex::kInvalid) depthCounted = std::max(depthCounted, tree.getDepth(lca));
+            }
+
+            nodes.insert(it, v);
+        }
+
+        for (Index a = v; ; a = tree.getParent(a)) {
+            auto & s = m_stats[a];
+            s.nNodes += 1;
+            s.maxDepth = std::max(s.maxDepth, depth);
+            s.maxFrames = std::max(s.maxFrames, frames[v]);
+            if (player >= 0 && tree.getDepth(a) > depthCounted) s.nPlayers += 1;
+
+            if (tree.getParent(a) == a) break;
+        }
+    }
+
+    return true;
+}
+
+}
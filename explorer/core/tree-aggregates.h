@@ -0,0 +1,52 @@
+#pragma once
+
+#include "core/tree-index.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace ImVid {
+
+// Per-node aggregates over the subtree of each node of a TreeIndex
+//
+// The values are computed with a single post-order pass. When the tree only grew by appending nodes
+// (the parents of the existing nodes did not change), update() adds the new nodes along their
+// ancestor paths instead of recomputing everything.
+//
+struct TreeAggregates {
+public:
+    using Index = TreeIndex::Index;
+
+    struct Stats {
+        int32_t nNodes = 0;    // number of nodes in the subtree, including the node itself
+        int32_t maxDepth = 0;  // depth of the deepest node in the subtree
+        int32_t nPlayers = 0;  // number of distinct players in the subtree
+        int32_t maxFrames = 0; // max frames of a node in the subtree
+    };
+
+    TreeAggregates();
+    ~TreeAggregates();
+
+    // players[i] is the interned player of node i (-1 for none), frames[i] its number of frames
+    bool update(const TreeIndex & tree, const std::vector<int32_t> & players, const std::vector<int32_t> & frames);
+    bool clear();
+
+    int size() const { return (int) m_stats.size(); }
+
+    const Stats & get(Index v) const { return m_stats[v]; }
+
+private:
+    bool build(const TreeIndex & tree, const std::vector<int32_t> & players, const std::vector<int32_t> & frames);
+    bool append(const TreeIndex & tree, const std::vector<int32_t> & players, const std::vector<int32_t> & frames);
+
+    std::vector<Stats> m_stats;
+
+    // parents of the aggregated nodes - used to detect if the tree only grew
+    std::vector<Index> m_parents;
+
+    // aggregated nodes of each player, in Euler tour order - appending nodes does not change the relative order
+    // of the existing ones, because the children are visited in index order
+    std::vector<std::vector<Index>> m_playerNodes;
+};
+
+}
@@ -0,0 +1,151 @@
+#include "core/tree-index.h"
+
+#include <cstdio>
+
+namespace ImVid {
+
+TreeIndex::TreeIndex() {}
+
+TreeIndex::~TreeIndex() {}
+
+bool TreeIndex::build(const std::vector<Index> & parents) {
+    clear();
+
+    const int n = (int) parents.size();
+    if (n == 0) return false;
+
+    m_parent.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const auto p = parents[i];
+        if (p < kInvalid || p >= n) {
+            fprintf(stderr, "Invalid parent %d of tree node %d\n", p, i);
+            clear();
+            return false;
+        }
+        m_parent[i] = p == kInvalid ? i : p;
+    }
+
+    // children in CSR form
+    std::vector<int32_t> childBegin(n + 1, 0);
+    std::vector<Index> children(n);
+    for (int i = 0; i < n; ++i) {
+        if (m_parent[i] != i) ++childBegin[m_parent[i] + 1];
+    }
+    for (int i = 0; i < n; ++i) {
+        childBegin[i + 1] += childBegin[i];
+    }
+    {
+        std::vector<int32_t> pos(childBegin.begin(), childBegin.end() - 1);
+        for (int i = 0; i < n; ++i) {
+            if (m_parent[i] != i) children[pos[m_parent[i]]++] = i;
+        }
+    }
+
+    // iterative DFS from every root - the trees can be deeper than the call stack allows
+    m_depth.assign(n, 0);
+    m_tin.assign(n, -1);
+    m_tout.assign(n, -1);
+    m_order.reserve(n);
+
+    int maxDepth = 0;
+    std::vector<std::pair<Index, int32_t>> stack;
+    for (int r = 0; r < n; ++r) {
+        if (m_parent[r] != r) continue;
+
+        m_tin[r] = (int) m_order.size();
+        m_order.push_back(r);
+        stack.push_back({ r, childBegin[r] });
+
+        while (stack.empty() == false) {
+            auto & [v, next] = stack.back();
+            if (next == childBegin[v + 1]) {
+                m_tout[v] = (int) m_order.size();
+                stack.pop_back();
+                continue;
+            }
+
+            const auto c = children[next++];
+            m_depth[c] = m_depth[v] + 1;
+            if (m_depth[c] > maxDepth) maxDepth = m_depth[c];
+
+            m_tin[c] = (int) m_order.size();
+            m_order.push_back(c);
+            stack.push_back({ c, childBegin[c] });
+        }
+    }
+
+    if ((int) m_order.size() != n) {
+        fprintf(stderr, "Tree contains a cycle - %d of %d nodes are reachable from a root\n", (int) m_order.size(), n);
+        clear();
+        return false;
+    }
+
+    m_nLevels = 1;
+    while ((1 << m_nLevels) <= maxDepth) ++m_nLevels;
+
+    m_up.resize((size_t) m_nLevels*n);
+    for (int i = 0; i < n; ++i) {
+        m_up[i] = m_parent[i];
+    }
+    for (int k = 1; k < m_nLevels; ++k) {
+        const Index * prev = m_up.data() + (size_t) (k - 1)*n;
+        Index * cur = m_up.data() + (size_t) k*n;
+        for (int i = 0; i < n; ++i) {
+            cur[i] = prev[prev[i]];
+        }
+    }
+
+    return true;
+}
+
+bool TreeIndex::clear() {
+    m_nLevels = 0;
+    m_parent.clear();
+    m_depth.clear();
+    m_order.clear();
+    m_tin.clear();
+    m_tout.clear();
+    m_up.clear();
+
+    return true;
+}
+
+TreeIndex::Index TreeIndex::getAncestor(Index v, int k) const {
+    if (k < 0 || k > m_depth[v]) return kInvalid;
+
+    const int n = size();
+    for (int i = 0; k > 0; ++i, k >>= 1) {
+        if (k & 1) v = m_up[(size_t) i*n + v];
+    }
+
+    return v;
+}
+
+TreeIndex::Index TreeIndex::getLCA(Index a, Index b) const {
+    if (isAncestor(a, b)) return a;
+    if (isAncestor(b, a)) return b;
+
+    const int n = size();
+    for (int k = m_nLevels - 1; k >= 0; --k) {
+        const auto p = m_up[(size_t) k*n + a];
+        if (isAncestor(p, b) == false) a = p;
+    }
+
+    a = m_parent[a];
+
+    return isAncestor(a, b) ? a : kInvalid;
+}
+
+bool TreeIndex::getPath(Index v, Index a, std::vector<Index> & res) const {
+    if (isValid() == false) return false;
+
+    while (true) {
+        res.push_back(v);
+        if (v == a || m_parent[v] == v) break;
+        v = m_parent[v];
+    }
+
+    return true;
+}
+
+}
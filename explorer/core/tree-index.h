@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace ImVid {
+
+// Ancestor queries over a forest given as a dense parent array
+// Nodes are addressed by their index in the parent array. A node whose parent is itself (or -1) is a root.
+//
+//  - Euler tour (pre-order enter / exit times) answers "is a an ancestor of b" in O(1)
+//  - binary lifting tables answer k-th ancestor and LCA in O(log n)
+//
+struct TreeIndex {
+public:
+    using Index = int32_t;
+
+    static constexpr Index kInvalid = -1;
+
+    TreeIndex();
+    ~TreeIndex();
+
+    bool build(const std::vector<Index> & parents);
+    bool clear();
+
+    bool isValid() const { return m_parent.empty() == false; }
+    int size() const { return (int) m_parent.size(); }
+
+    Index getParent(Index v) const { return m_parent[v]; }
+    int getDepth(Index v) const { return m_depth[v]; }
+
+    // nodes in Euler tour (pre-order) - the subtree of v is [getEnter(v), getExit(v)) in this order
+    const std::vector<Index> & getOrder() const { return m_order; }
+    int getEnter(Index v) const { return m_tin[v]; }
+    int getExit(Index v) const { return m_tout[v]; }
+
+    // true if a == b or a lies on the path from b to its root
+    bool isAncestor(Index a, Index b) const { return m_tin[a] <= m_tin[b] && m_tout[b] <= m_tout[a]; }
+
+    // returns kInvalid if v has less than k ancestors
+    Index getAncestor(Index v, int k) const;
+
+    // lowest common ancestor, or kInvalid if a and b are in different trees
+    Index getLCA(Index a, Index b) const;
+
+    // appends the nodes from v up to (and including) its ancestor a - O(depth(v) - depth(a))
+    // if a is not an ancestor of v, the path goes up to the root
+    bool getPath(Index v, Index a, std::vector<Index> & res) const;
+
+private:
+    int m_nLevels = 0;
+
+    std::vector<Index> m_parent;
+    std::vector<int32_t> m_depth;
+
+    std::vector<Index> m_order;
+    std::vector<int32_t> m_tin;
+    std::vector<int32_t> m_tout;
+
+    // m_up[k*n + v] is the 2^k-th ancestor of v (roots point to themselves)
+    std::vector<Index> m_up;
+};
+
+}
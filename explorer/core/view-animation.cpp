@@ -0,0 +1,47 @@
+#include "core/view-animation.h"
+
+#include <cmath>
+
+namespace ImVid {
+
+bool interp(float & x, float x0, float x1, float t0, float t1, float t, int type, bool isZoom) {
+    // the zoom out of type 4 leaves the target even if it starts there
+    if (x == x1 && type != 4) return false;
+    if (t < t0) {
+        x = x0;
+        return true;
+    }
+    if (t >= t1) {
+        const bool res = x != x1;
+        x = x1;
+        return res;
+    }
+
+    float f = (t - t0)/(t1 - t0);
+    if (type == 1) {
+        x = x0 + (x1 - x0)*std::pow(f, 4);
+    } else if (type == 2) {
+        x = x0 + (x1 - x0)*std::pow(f, 0.5);
+    } else if (type == 3) {
+        x = x0 + (x1 - x0)*(f*f*(3.0f - 2.0f*f));
+    } else if (type == 4) {
+        if (isZoom) {
+            if (f < 0.5f) {
+                f = 2.0f*f;
+                x = x0 + (0.1f - x0)*(f*f*(3.0f - 2.0f*f));
+            } else {
+                f = 2.0f*(f - 0.5f);
+                x = 0.1f + (x1 - 0.1f)*(f*f*(3.0f - 2.0f*f));
+            }
+        } else {
+            x = x0 + (x1 - x0)*(f*f*(3.0f - 2.0f*f));
+        }
+    } else {
+        // linear
+        x = x0 + ((x1 - x0)/(t1 - t0))*(t - t0);
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace ImVid {
+
+// Easing of one coordinate of the view between t0 and t1
+//
+// type: 1 - ease in, 2 - ease out, 3 - smoothstep, 4 - zoom out to 0.1 and back in (for isZoom), other - linear
+//
+// Returns true while the coordinate changes. Once t reaches t1 the coordinate is set to x1 and the following
+// calls return false, so that the main loop can go idle after the animation ends.
+//
+bool interp(float & x, float x0, float x1, float t0, float t1, float t, int type, bool isZoom);
+
+}
@@ -0,0 +1,121 @@
+#include "core/worker-pool.h"
+
+#ifdef USE_THREADS
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+namespace ImVid {
+
+#ifdef USE_THREADS
+struct WorkerPool::Data {
+    bool isStopping = false;
+    int nBusy = 0;
+
+    std::mutex mutex;
+    std::condition_variable cvTask;
+    std::condition_variable cvIdle;
+
+    std::deque<Task> tasks;
+    std::vector<std::thread> threads;
+
+    void run() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cvTask.wait(lock, [this]() { return isStopping || tasks.empty() == false; });
+                if (tasks.empty()) return;
+
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                ++nBusy;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --nBusy;
+                if (nBusy == 0 && tasks.empty()) cvIdle.notify_all();
+            }
+        }
+    }
+};
+#else
+struct WorkerPool::Data {
+};
+#endif
+
+WorkerPool::WorkerPool() : m_data(new Data()) {}
+
+WorkerPool::~WorkerPool() {
+    free();
+}
+
+bool WorkerPool::init(int nThreads) {
+    free();
+
+#ifdef USE_THREADS
+    for (int i = 0; i < nThreads; ++i) {
+        m_data->threads.emplace_back([this]() { m_data->run(); });
+    }
+#else
+    (void) nThreads;
+#endif
+
+    return true;
+}
+
+bool WorkerPool::free() {
+#ifdef USE_THREADS
+    {
+        std::lock_guard<std::mutex> lock(m_data->mutex);
+        m_data->isStopping = true;
+    }
+    m_data->cvTask.notify_all();
+
+    for (auto & thread : m_data->threads) {
+        thread.join();
+    }
+    m_data->threads.clear();
+    m_data->isStopping = false;
+#endif
+
+    return true;
+}
+
+int WorkerPool::getNumThreads() const {
+#ifdef USE_THREADS
+    return (int) m_data->threads.size();
+#else
+    return 0;
+#endif
+}
+
+void WorkerPool::submit(Task && task) {
+#ifdef USE_THREADS
+    if (m_data->threads.empty() == false) {
+        {
+            std::lock_guard<std::mutex> lock(m_data->mutex);
+            m_data->tasks.push_back(std::move(task));
+        }
+        m_data->cvTask.notify_one();
+        return;
+    }
+#endif
+
+    task();
+}
+
+void WorkerPool::wait() {
+#ifdef USE_THREADS
+    std::unique_lock<std::mutex> lock(m_data->mutex);
+    m_data->cvIdle.wait(lock, [this]() { return m_data->nBusy == 0 && m_data->tasks.empty(); });
+#endif
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+
+namespace ImVid {
+
+// Fixed set of worker threads that run queued tasks
+//
+// Without USE_THREADS, or when initialized with 0 threads (e.g. SharedArrayBuffer is not available in the
+// browser), the tasks run immediately on the calling thread, so the callers need a single code path.
+//
+struct WorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    WorkerPool();
+    ~WorkerPool();
+
+    bool init(int nThreads);
+    bool free();
+
+    int getNumThreads() const;
+
+    // runs the task on one of the workers, or right away if there are none
+    void submit(Task && task);
+
+    // blocks until all submitted tasks are finished - do not call on the browser main thread
+    void wait();
+
+private:
+    struct Data;
+    std::unique_ptr<Data> m_data;
+};
+
+}
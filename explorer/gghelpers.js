@@ -9,6 +9,17 @@ function checkSharedArrayBuffer() {
     return true;
 }
 
+// validates a tiny module with a v128 instruction - browsers without WebAssembly SIMD reject it
+function checkWasmSimd() {
+    try {
+        return WebAssembly.validate(new Uint8Array([
+            0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11
+        ]));
+    } catch (e) {
+        return false;
+    }
+}
+
 function findGetParameter(parameterName) {
     var result = null,
         tmp = [];
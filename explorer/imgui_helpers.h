@@ -10,7 +10,7 @@ bool ImGui_tryLoadFont(const std::string & filename, float size = 14.0f, bool me
     printf(" - success\n");
     if (merge) {
         // todo : ugly static !!!
-        static ImWchar ranges[] = { 0xf000, 0xf3ff, 0 };
+        static ImWchar ranges[] = { ::ImVid::BakedFonts::kIconsFirst, ::ImVid::BakedFonts::kIconsLast, 0 };
         static ImFontConfig config;
 
         config.MergeMode = true;
@@ -23,6 +23,66 @@ bool ImGui_tryLoadFont(const std::string & filename, float size = 14.0f, bool me
     return true;
 }
 
+// marks the atlas as built - the flag exists only in newer imgui versions, where NewFrame() checks it
+template <typename Atlas>
+auto ImGui_setTexReady(Atlas * atlas, int) -> decltype(atlas->TexReady = true, void()) { atlas->TexReady = true; }
+template <typename Atlas>
+void ImGui_setTexReady(Atlas * , long) {}
+
+// installs the fonts rasterized by t2d-bake-assets, so that the atlas is not built at startup
+// the glyph tables are valid only for the imgui version of the baker - otherwise the fonts are not loaded
+bool ImGui_tryLoadBakedFonts(const ::ImVid::BakedFonts & baked) {
+    if (baked.fonts.empty() || baked.texAlpha.empty()) {
+        printf("No baked fonts available\n");
+        return false;
+    }
+
+    if (baked.imguiVersion != IMGUI_VERSION_NUM) {
+        printf("The fonts were baked with imgui %d instead of %d\n", baked.imguiVersion, IMGUI_VERSION_NUM);
+        return false;
+    }
+
+    auto atlas = ImGui::GetIO().Fonts;
+    atlas->Clear();
+
+    for (const auto & cur : baked.fonts) {
+        auto font = IM_NEW(ImFont);
+        font->FontSize = cur.size;
+        font->Ascent = cur.ascent;
+        font->Descent = cur.descent;
+        font->ContainerAtlas = atlas;
+
+        for (const auto & glyph : cur.glyphs) {
+            font->AddGlyph(nullptr, (ImWchar) glyph.codepoint,
+                           glyph.x0, glyph.y0, glyph.x1, glyph.y1,
+                           glyph.u0, glyph.v0, glyph.u1, glyph.v1,
+                           glyph.advanceX);
+        }
+        font->BuildLookupTable();
+
+        atlas->Fonts.push_back(font);
+    }
+
+    atlas->TexWidth = baked.texSizeX;
+    atlas->TexHeight = baked.texSizeY;
+    atlas->TexUvScale = { 1.0f/baked.texSizeX, 1.0f/baked.texSizeY };
+    atlas->TexUvWhitePixel = { baked.uvWhitePixel[0], baked.uvWhitePixel[1] };
+    for (int i = 0; i < (int) baked.uvLines.size() && i <= IM_DRAWLIST_TEX_LINES_WIDTH_MAX; ++i) {
+        const auto & uv = baked.uvLines[i];
+        atlas->TexUvLines[i] = { uv[0], uv[1], uv[2], uv[3] };
+    }
+
+    // the atlas owns the pixels and releases them with IM_FREE
+    atlas->TexPixelsAlpha8 = (unsigned char *) IM_ALLOC(baked.texAlpha.size());
+    memcpy(atlas->TexPixelsAlpha8, baked.texAlpha.data(), baked.texAlpha.size());
+
+    ImGui_setTexReady(atlas, 0);
+
+    printf("Loaded %d baked fonts, %d x %d texture\n", (int) baked.fonts.size(), baked.texSizeX, baked.texSizeY);
+
+    return true;
+}
+
 bool ImGui_BeginFrame(SDL_Window * window) {
     ImGui_NewFrame(window);
 
@@ -3,6 +3,19 @@
 #include "common.h"
 
 #include "core/assets.h"
+#include "core/baked-assets.h"
+#include "core/chunk-set.h"
+#include "core/level-layout.h"
+#include "core/node-details.h"
+#include "core/parallel-draw-list.h"
+#include "core/search-index.h"
+#include "core/snapshot-decoder.h"
+#include "core/space-filling-curve.h"
+#include "core/simd-kernels.h"
+#include "core/tree-aggregates.h"
+#include "core/tree-index.h"
+#include "core/view-animation.h"
+#include "core/worker-pool.h"
 
 #include "imgui-extra/imgui_impl.h"
 #include "imgui/imgui_internal.h"
@@ -11,21 +24,33 @@
 #include "icons_font_awesome.h"
 #endif
 
-#ifdef USE_LINE_SHADER
+#if defined(USE_LINE_SHADER) || defined(USE_GPU_PICKING)
 #include "core/frame-buffer.h"
 #include "core/shader-program.h"
 #endif
 
+#ifdef USE_LINE_SHADER
+#include "core/tile-cache.h"
+#endif
+
 #include <SDL.h>
 #include <SDL_opengl.h>
 
-#include <set>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cstring>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <functional>
 #include <unordered_map>
 
+#ifdef USE_THREADS
+#include <thread>
+#endif
+
 #ifdef __EMSCRIPTEN__
 #include <emscripten.h>
 #include <emscripten/bind.h>
@@ -37,12 +62,50 @@
 
 // Constants
 
-const float kFontScale = 2.0f;
+const float kFontScale = ::ImVid::BakedFonts::kScale;
 const float kSizeX0 = 1000.0f;
 const float kStepPos = 100.0f;
 const float kAnimTime = 0.25f;
 const float kWindowFadeTime = 0.25f;
 
+// number of frames to render after each input event so that imgui can settle hover / popup state
+const int kRedrawFramesPerEvent = 3;
+// max time to block waiting for events when there is nothing to redraw
+const int kIdleWaitTimeout_ms = 1000;
+
+// threads for decoding, rebuilding the tree structures and building the draw lists - one core is left for
+// the render thread, which takes part in the draw lists too. In the browser the threads come from a fixed pool
+#ifdef __EMSCRIPTEN__
+const int kMaxWorkerThreads = 4;
+#else
+const int kMaxWorkerThreads = 64;
+#endif
+
+// max number of search results to cycle through
+const int kSearchMaxResults = 1000;
+
+// spatial chunks of a large tree - max number of loaded chunk nodes and of chunks requested at once
+const int kChunksMaxNodes = 300000;
+const int kChunksMaxInFlight = 4;
+
+// command details fetched on demand - max bytes of cached text, max commands on the highlighted path to prefetch
+const size_t kDetailsMaxBytes = 8*1024*1024;
+const int kDetailsMaxPrefetch = 32;
+// characters of the input shown in the node popup
+const int kDetailsMaxInput = 64;
+
+#ifdef USE_LINE_SHADER
+// edges are rasterized in square world-space tiles
+// a tile at level L covers kEdgeTileSize*2^L world units
+const int kEdgeTileSize = 512;
+// initial number of cached tiles - the cache grows to hold all tiles that can be visible at once, see
+// getEdgeTileCacheSize()
+const int kEdgeTileCacheSize = 32;
+const int kEdgeTileMaxRendersPerFrame = 4;
+// number of coarser levels to look for while a tile is not rendered yet
+const int kEdgeTileMaxFallbackLevels = 3;
+#endif
+
 const auto kColorBackground      = ImGui::ColorConvertFloat4ToU32({ float(0x0A)/256.0f, float(0x10)/256.0f, float(0x16)/256.0f, 0.50f });
 const auto kColorEdge            = ImGui::ColorConvertFloat4ToU32({ float(0x1D)/256.0f, float(0xA1)/256.0f, float(0xF2)/256.0f, 0.40f });
 const auto kColorEdgeSelected    = ImGui::ColorConvertFloat4ToU32({ float(0x1D)/256.0f, float(0xA1)/256.0f, float(0xF2)/256.0f, 0.80f });
@@ -56,6 +119,8 @@ namespace {
 template <typename T>
 int sgn(T x) { return x < 0 ? -1 : x > 0 ? 1 : 0; }
 
+inline int floorDiv(int a, int b) { return a/b - ((a % b != 0) && ((a < 0) != (b < 0))); }
+
 bool ScrollWhenDraggingOnVoid(ImVec2 delta, ImGuiMouseButton mouse_button) {
     if (ImGui::GetIO().MouseDownDuration[ImGuiMouseButton_Left] == 0.0f) {
         delta = { 0.0f, 0.0f, };
@@ -89,12 +154,28 @@ static std::function<bool()> g_doInit;
 static std::function<void(int, int)> g_setWindowSize;
 static std::function<void(float, float, float, int)> g_setPinch;
 static std::function<bool()> g_mainUpdate;
-static std::function<void(const NodeId & , const std::string & , int, int, int, int)> g_addNode;
+static std::function<void(const NodeId & , const std::string & , int, int, int, int, int)> g_addNode;
 static std::function<void(const NodeId & , int, int)> g_updateNodePosition;
 static std::function<void(const NodeId & , const NodeId & )> g_addEdge;
 static std::function<void(const NodeId & )> g_focusNode;
 static std::function<std::string()> g_getActionOpenUrl;
 static std::function<void()> g_treeChanged;
+static std::function<void()> g_snapshotBegin;
+static std::function<bool(const uint8_t * , size_t)> g_snapshotFeed;
+static std::function<bool()> g_snapshotNextSegment;
+static std::function<bool()> g_snapshotFinish;
+static std::function<bool(const uint8_t * , size_t)> g_snapshotRestore;
+static std::function<bool(std::vector<uint8_t> & )> g_snapshotSave;
+static std::function<bool()> g_chunksInit;
+static std::function<int(const std::string & , float, float, float, float, int)> g_chunksAdd;
+static std::function<void(std::vector<int> & )> g_chunksUpdate;
+static std::function<const std::string & (int)> g_chunksGetName;
+static std::function<bool(int)> g_chunksRequest;
+static std::function<bool(int, const uint8_t * , size_t)> g_chunksLoad;
+static std::function<bool(int)> g_chunksFailed;
+static std::function<void(std::vector<std::string> & )> g_detailsGetRequests;
+static std::function<bool(const std::string & , const uint8_t * , size_t)> g_detailsLoad;
+static std::function<void(const std::string & )> g_detailsFailed;
 
 void mainUpdate(void *) {
     g_mainUpdate();
@@ -122,13 +203,43 @@ extern "C" {
         void tree_changed() {
             g_treeChanged();
         }
+
+    EMSCRIPTEN_KEEPALIVE
+        void snapshot_begin() {
+            g_snapshotBegin();
+        }
+
+    EMSCRIPTEN_KEEPALIVE
+        int snapshot_next_segment() {
+            return g_snapshotNextSegment();
+        }
+
+    EMSCRIPTEN_KEEPALIVE
+        int snapshot_finish() {
+            return g_snapshotFinish();
+        }
+
+    EMSCRIPTEN_KEEPALIVE
+        int chunks_init() {
+            return g_chunksInit();
+        }
+
+    EMSCRIPTEN_KEEPALIVE
+        int chunks_request(int index) {
+            return g_chunksRequest(index);
+        }
+
+    EMSCRIPTEN_KEEPALIVE
+        int chunks_failed(int index) {
+            return g_chunksFailed(index);
+        }
 }
 
 #ifdef __EMSCRIPTEN__
 EMSCRIPTEN_BINDINGS(tweet2doom) {
     emscripten::function("add_node", emscripten::optional_override(
-                    [](const std::string & id, const std::string & username, int level, int type, int x, int y) {
-                        g_addNode(std::stoll(id), username, level, type, x, y);
+                    [](const std::string & id, const std::string & username, int level, int type, int x, int y, int frames) {
+                        g_addNode(std::stoll(id), username, level, type, x, y, frames);
                     }));
 
     emscripten::function("add_edge", emscripten::optional_override(
@@ -151,6 +262,81 @@ EMSCRIPTEN_BINDINGS(tweet2doom) {
                     []() {
                         return g_getActionOpenUrl();
                     }));
+
+    emscripten::function("snapshot_feed", emscripten::optional_override(
+                    [](const emscripten::val & chunk) {
+                        const auto data = emscripten::convertJSArrayToNumberVector<uint8_t>(chunk);
+                        return g_snapshotFeed(data.data(), data.size());
+                    }));
+
+    emscripten::function("snapshot_restore", emscripten::optional_override(
+                    [](const emscripten::val & saved) {
+                        const auto data = emscripten::convertJSArrayToNumberVector<uint8_t>(saved);
+                        return g_snapshotRestore(data.data(), data.size());
+                    }));
+
+    emscripten::function("snapshot_save", emscripten::optional_override(
+                    []() {
+                        std::vector<uint8_t> data;
+                        if (g_snapshotSave(data) == false) return emscripten::val::null();
+
+                        // copy out of the heap - the view is invalidated when the memory grows
+                        return emscripten::val::global("Uint8Array").new_(emscripten::typed_memory_view(data.size(), data.data()));
+                    }));
+
+    emscripten::function("chunks_add", emscripten::optional_override(
+                    [](const std::string & name, float xmin, float ymin, float xmax, float ymax, int nNodes) {
+                        return g_chunksAdd(name, xmin, ymin, xmax, ymax, nNodes);
+                    }));
+
+    // the chunks to fetch next, as [ index, name ] pairs
+    emscripten::function("chunks_update", emscripten::optional_override(
+                    []() {
+                        std::vector<int> toLoad;
+                        g_chunksUpdate(toLoad);
+
+                        auto res = emscripten::val::array();
+                        for (const auto i : toLoad) {
+                            auto cur = emscripten::val::array();
+                            cur.call<void>("push", i);
+                            cur.call<void>("push", g_chunksGetName(i));
+                            res.call<void>("push", cur);
+                        }
+
+                        return res;
+                    }));
+
+    emscripten::function("chunks_load", emscripten::optional_override(
+                    [](int index, const emscripten::val & chunk) {
+                        const auto data = emscripten::convertJSArrayToNumberVector<uint8_t>(chunk);
+                        return g_chunksLoad(index, data.data(), data.size());
+                    }));
+
+    // the names of the detail shards to fetch next
+    emscripten::function("details_get_requests", emscripten::optional_override(
+                    []() {
+                        std::vector<std::string> shards;
+                        g_detailsGetRequests(shards);
+
+                        auto res = emscripten::val::array();
+                        for (const auto & shard : shards) {
+                            res.call<void>("push", shard);
+                        }
+
+                        return res;
+                    }));
+
+    // an empty array for a shard that does not exist
+    emscripten::function("details_load", emscripten::optional_override(
+                    [](const std::string & name, const emscripten::val & shard) {
+                        const auto data = emscripten::convertJSArrayToNumberVector<uint8_t>(shard);
+                        return g_detailsLoad(name, data.data(), data.size());
+                    }));
+
+    emscripten::function("details_failed", emscripten::optional_override(
+                    [](const std::string & name) {
+                        g_detailsFailed(name);
+                    }));
 }
 #endif
 
@@ -164,6 +350,10 @@ struct Node {
     int type;
     float x;
     float y;
+    int frames = 0;
+
+    // index in the dense tree index - assigned in insertion order, so appending nodes does not move existing ones
+    ::ImVid::TreeIndex::Index idx = ::ImVid::TreeIndex::kInvalid;
 };
 
 struct Edge {
@@ -171,6 +361,47 @@ struct Edge {
     NodeId dst;
 };
 
+// line segments as separate coordinate arrays, for the SIMD kernels
+struct Segments {
+    std::vector<float> x0;
+    std::vector<float> y0;
+    std::vector<float> x1;
+    std::vector<float> y1;
+
+    int size() const { return (int) x0.size(); }
+
+    void clear() {
+        x0.clear();
+        y0.clear();
+        x1.clear();
+        y1.clear();
+    }
+};
+
+// tree structures built on the worker pool - handed over to the render thread all at once
+struct TreeData {
+    // the nodes at the time of the rebuild and their ids - State::treeIds can be compacted meanwhile
+    std::vector<const Node *> treeNodes;
+    std::vector<NodeId> treeIds;
+    ::ImVid::TreeIndex treeIndex;
+
+    // subtree size, depth, players and frames of each node
+    ::ImVid::TreeAggregates treeAggregates;
+
+    // search by player name or id prefix
+    ::ImVid::SearchIndex searchIndex;
+
+    // nodes by level and x for culling
+    ::ImVid::LevelLayout levelLayout;
+
+    // bounding box of the nodes
+
+    float bbxmin = 1e10;
+    float bbxmax = -1e10;
+    float bbymin = 1e10;
+    float bbymax = -1e10;
+};
+
 const auto kZoomMin = 0.1f;
 const auto kZoomMax = 1.0f;
 const auto kZoomMinLog = std::log(kZoomMin);
@@ -185,6 +416,7 @@ enum class EWindowKind {
     Help,
     Statistics,
     Achievements,
+    Search,
 };
 
 enum class EAchievementType {
@@ -241,6 +473,8 @@ struct Achievement {
 std::unordered_map<int64_t, Node> g_nodes;
 std::vector<Edge> g_edges;
 
+::ImVid::NodeDetails g_nodeDetails;
+
 std::map<NodeId, Achievement> g_achievementsMap;
 std::vector<Achievement> g_achievements = {
     { 1451989230201315328, 1452303875990593539, EAchievementType::Speedrun,       "E1M2 Best time 0:31", },
@@ -278,19 +512,18 @@ struct State {
     View viewCur;
     Animation anim;
 
-    // used to render the line shader texture
-    // stores infro on time of rendering
-    float posEdgesX = 0.0f;
-    float posEdgesY = 0.0f;
-    float scaleEdges = 0.0f;
-
     float aspectRatio = 1.0f;
 
     NodeId rootId;
     NodeId focusId;
     NodeId selectedId;
+    NodeId markedId = 0;
 
-    int nUpdates = 2;
+    // redraw scheduling
+    // frames are rendered only when something invalidated the view
+    int nRedrawFrames = 2;
+    float redrawUntilT = 0.0f;
+    bool isMainLoopPaused = false;
 
     bool isMoving = false;
     bool wasMoving = true;
@@ -323,8 +556,6 @@ struct State {
     float popupShowT0 = 0.0f;
 
     // rendering
-    bool forceRender = false;
-    int nSkipUpdate = 0;
     Rendering rendering;
 
     // windows
@@ -340,11 +571,64 @@ struct State {
 
     ::ImVid::Assets assets;
 
+    // tree rebuilds run on the worker pool - the last task to finish publishes the result in treePending
+    // only one rebuild is in flight, changes that arrive meanwhile wait for it
+    ::ImVid::WorkerPool workerPool;
+    bool isTreeBuilding = false;
+    std::atomic<int> treeTasksLeft { 0 };
+    std::atomic<TreeData *> treePending { nullptr };
+
+    // the aggregates are updated incrementally, so the rebuild keeps its own copy
+    ::ImVid::TreeAggregates treeAggregatesBuilder;
+
+    // treeIds maps the dense tree index back to node ids - nodes added after the last rebuild are not in tree yet
+    std::vector<NodeId> treeIds;
+    std::unordered_map<std::string, int32_t> playerIds;
+    std::unique_ptr<TreeData> tree = std::make_unique<TreeData>();
+
+    // items that passed the culling in the current frame and their positions - world units, then screen pixels
+    std::vector<const Node *> visibleItems;
+    std::vector<float> visibleX;
+    std::vector<float> visibleY;
+    Segments visibleEdges;
+
+    // draw lists of the visible items built on the worker pool
+    ::ImVid::ParallelDrawList drawListParallel;
+
+    // indices produced by the cull kernels
+    std::vector<int32_t> cullIdx;
+
+    // search by player name or id prefix
+    char searchText[64] = "";
+    std::string searchQuery;
+    std::vector<::ImVid::SearchIndex::Index> searchResults;
+    int searchTotal = 0;
+    int searchCur = -1;
+
+    // highlighted path in world space: selected -> root, or selected -> common ancestor -> marked
+    bool isPathValid = false;
+    NodeId pathSelectedId = 0;
+    NodeId pathMarkedId = 0;
+    NodeId pathCommonId = 0;
+    std::vector<ImVec2> pathPoints;
+    std::vector<ImVec2> pathPointsRender;
+
 #ifdef USE_LINE_SHADER
-    ::ImVid::FrameBuffer fboEdges;
+    ::ImVid::TileCache tilesEdges;
     ::ImVid::ShaderProgram shaderEdges;
 #endif
 
+#ifdef USE_GPU_PICKING
+    // items that can be clicked in the current frame, in render order
+    // the id of an item is its index + 1, 0 is the background
+    std::vector<NodeId> pickIds;
+    std::vector<ImVec2> pickPositions;
+    std::vector<std::array<float, 4>> pickRects;
+
+    ::ImVid::FrameBuffer fboPick;
+    ::ImVid::ShaderProgram shaderPick;
+#endif
+
     void initRendering() {
         rendering.T = ImGui::GetTime();
         rendering.wSize = ImGui::GetContentRegionAvail();
@@ -380,19 +664,104 @@ struct State {
                 ImGui::GetIO().MousePos.y < ImGui::GetIO().DisplaySize.y - 1.25f*heightControls);
     }
 
-    inline ImVec2 getRenderPosition(const Node & node) const {
+    inline ImVec2 getRenderPosition(float x, float y) const {
         return ImVec2{
-            (node.x - rendering.xmin)*rendering.idx*rendering.wSize.x,
-                (node.y - rendering.ymin)*rendering.idy*rendering.wSize.y,
+            (x - rendering.xmin)*rendering.idx*rendering.wSize.x,
+                (y - rendering.ymin)*rendering.idy*rendering.wSize.y,
         };
     }
 
+    inline ImVec2 getRenderPosition(const Node & node) const {
+        return getRenderPosition(node.x, node.y);
+    }
+
+    // world -> screen for whole arrays, in place
+    inline void getRenderPositions(std::vector<float> & x, std::vector<float> & y) const {
+        ::ImVid::transformPoints(x.size(), x.data(), y.data(),
+                rendering.xmin, rendering.ymin, rendering.idx*rendering.wSize.x, rendering.idy*rendering.wSize.y, x.data(), y.data());
+    }
+
+    // screen pixels -> world units
+    inline ImVec2 getWorldSize(float px) const {
+        return ImVec2{ px*rendering.dx/rendering.wSize.x, px*rendering.dy/rendering.wSize.y, };
+    }
+
+    // nodes (or commands) inside the world rect and their positions, in level order and sorted by x within a level
+    void getVisibleItems(bool isCommand, float x0, float y0, float x1, float y1,
+                         std::vector<const Node *> & res, std::vector<float> & resX, std::vector<float> & resY) {
+        res.clear();
+        resX.clear();
+        resY.clear();
+
+        const auto & layout = tree->levelLayout;
+
+        const auto levels = layout.getLevels(y0, y1);
+        for (int l = levels.begin; l < levels.end; ++l) {
+            const auto & level = layout.getLevel(l);
+            if (level.ymax < y0 || level.ymin > y1) continue;
+
+            const auto items = isCommand ? layout.getCommands(level, x0, x1) : layout.getNodes(level, x0, x1);
+            const int n = items.end - items.begin;
+            if (n == 0) continue;
+
+            const float * xs = layout.getItemsX() + items.begin;
+            const float * ys = layout.getItemsY() + items.begin;
+
+            cullIdx.resize(n);
+            const int m = ::ImVid::cullPoints(n, xs, ys, x0, y0, x1, y1, cullIdx.data());
+            for (int k = 0; k < m; ++k) {
+                const int i = cullIdx[k];
+                res.push_back(tree->treeNodes[layout.getItem(items.begin + i)]);
+                resX.push_back(xs[i]);
+                resY.push_back(ys[i]);
+            }
+        }
+    }
+
+    // edges whose bounding box intersects the world rect, child -> parent
+    void getVisibleEdges(float x0, float y0, float x1, float y1, Segments & res) {
+        res.clear();
+
+        const auto & layout = tree->levelLayout;
+
+        const auto levels = layout.getEdgeLevels(y0, y1);
+        for (int l = levels.begin; l < levels.end; ++l) {
+            const auto & level = layout.getLevel(l);
+            if (level.eymax < y0 || level.eymin > y1) continue;
+
+            const auto edges = layout.getEdges(level, x0, x1);
+            const int n = edges.end - edges.begin;
+            if (n == 0) continue;
+
+            const float * xa = layout.getEdgesSrcX() + edges.begin;
+            const float * ya = layout.getEdgesSrcY() + edges.begin;
+            const float * xb = layout.getEdgesDstX() + edges.begin;
+            const float * yb = layout.getEdgesDstY() + edges.begin;
+
+            cullIdx.resize(n);
+            const int m = ::ImVid::cullSegments(n, xa, ya, xb, yb, x0, y0, x1, y1, cullIdx.data());
+            for (int k = 0; k < m; ++k) {
+                const int i = cullIdx[k];
+                res.x0.push_back(xa[i]);
+                res.y0.push_back(ya[i]);
+                res.x1.push_back(xb[i]);
+                res.y1.push_back(yb[i]);
+            }
+        }
+    }
+
     inline float getRenderRadius(const Node & node) const {
         return std::max(0.5f, (node.type == 0 ? 92.0f : 32.0f)*rendering.iscale);
     }
 
-    inline auto getRenderCommand(const Node & node, const ImVec2 & pos) const {
-        const ImVec2 tSize = { ImGui::CalcTextSize(node.username.c_str()).x, rendering.textHScaled };
+    // radius of the root node - the largest of all items
+    inline float getRenderRadiusMax() const {
+        return std::max(0.5f, 92.0f*rendering.iscale);
+    }
+
+    // the text width can be measured by the caller - e.g. on a worker thread, directly with the font
+    inline auto getRenderCommand(const ImVec2 & pos, float textWidth) const {
+        const ImVec2 tSize = { textWidth, rendering.textHScaled };
         const ImVec2 tMargin = { 12.0f*rendering.iscale, 8.0f*rendering.iscale, };
         const ImVec2 pt = { pos.x - 0.5f*tSize.x, pos.y - 0.5f*tSize.y, };
         const ImVec2 p0 = { pos.x - 0.5f*tSize.x - tMargin.x, pos.y - 0.5f*tSize.y - tMargin.y, };
@@ -401,12 +770,346 @@ struct State {
         return std::tuple { pt, p0, p1 };
     }
 
+    inline auto getRenderCommand(const Node & node, const ImVec2 & pos) const {
+        return getRenderCommand(pos, ImGui::CalcTextSize(node.username.c_str()).x);
+    }
+
+    // request the next nFrames frames to be rendered
+    inline void requestRedraw(int nFrames = 1) {
+        nRedrawFrames = std::max(nRedrawFrames, nFrames);
+
+#ifdef __EMSCRIPTEN__
+        if (isMainLoopPaused) {
+            isMainLoopPaused = false;
+            emscripten_resume_main_loop();
+        }
+#endif
+    }
+
+    // keep rendering for the next dt seconds (e.g. window fades)
+    inline void requestRedrawFor(float dt) {
+        redrawUntilT = std::max(redrawUntilT, rendering.T + dt);
+        requestRedraw();
+    }
+
+    inline bool needsRedraw() const {
+        return nRedrawFrames > 0 || isMoving || isZooming || ImGui::GetTime() < redrawUntilT;
+    }
+
+#ifdef USE_LINE_SHADER
+    // pick the finest tile level for which a texel is not larger than a screen pixel
+    inline int getEdgeTileLevel(float scale) const {
+        const float sizePixels = std::max(1.0f, ImGui::GetIO().DisplaySize.x*ImGui::GetIO().DisplayFramebufferScale.x);
+        return std::floor(std::log2(scale*sizex0/sizePixels));
+    }
+
+    // a tile spans between kEdgeTileSize/2 and kEdgeTileSize pixels, so the cache must hold the tiles of a
+    // view of tiles of the smallest size, together with the coarser tiles used as fallback
+    inline int getEdgeTileCacheSize() const {
+        const auto & io = ImGui::GetIO();
+        const float sizeX = std::max(1.0f, io.DisplaySize.x*io.DisplayFramebufferScale.x);
+        const float sizeY = std::max(1.0f, io.DisplaySize.y*io.DisplayFramebufferScale.y);
+
+        int res = 0;
+        for (int i = 0; i < kEdgeTileMaxFallbackLevels; ++i) {
+            const float tilePixels = std::ldexp(0.5f*kEdgeTileSize, i);
+            res += (std::ceil(sizeX/tilePixels) + 1)*(std::ceil(sizeY/tilePixels) + 1);
+        }
+
+        return std::max(kEdgeTileCacheSize, res);
+    }
+#endif
+
+#ifdef USE_GPU_PICKING
+    inline void pickClear() {
+        pickIds.clear();
+        pickPositions.clear();
+        pickRects.clear();
+    }
+
+    inline void pickAdd(const NodeId & id, const ImVec2 & pos, const ImVec2 & p0, const ImVec2 & p1) {
+        pickIds.push_back(id);
+        pickPositions.push_back(pos);
+        pickRects.push_back({ p0.x, p0.y, p1.x, p1.y });
+    }
+
+    // render the id pass into a 1x1 frame buffer that covers the screen pixel at pos
+    // returns the index of the top-most item at that pixel, or -1
+    inline int pick(const ImVec2 & pos) {
+        if (pickRects.empty()) return -1;
+
+        if (fboPick.isAllocated() == false) {
+            if (fboPick.create(1, 1) == false) return -1;
+        }
+
+        // screen pixels -> NDC of the 1x1 buffer centered at pos
+        std::vector<std::array<float, 4>> rects(pickRects.size());
+        for (int i = 0; i < (int) pickRects.size(); ++i) {
+            rects[i] = {
+                2.0f*(pickRects[i][0] - pos.x), 2.0f*(pickRects[i][1] - pos.y),
+                2.0f*(pickRects[i][2] - pos.x), 2.0f*(pickRects[i][3] - pos.y),
+            };
+        }
+
+        fboPick.bind();
+        fboPick.clear();
+        fboPick.unbind();
+
+        shaderPick.renderRectsId(fboPick, rects);
+
+        std::array<uint8_t, 4> rgba;
+        if (fboPick.readPixel(0, 0, rgba) == false) return -1;
+
+        const int id = int(rgba[0]) | (int(rgba[1]) << 8) | (int(rgba[2]) << 16);
+
+        return id - 1;
+    }
+#endif
+
+    // gathers the tree into flat arrays and rebuilds the index structures on the worker pool
+    // the result is picked up by applyTreeData()
+    void buildTreeIndex() {
+        struct Input {
+            std::vector<::ImVid::TreeIndex::Index> parents;
+            std::vector<int32_t> players;
+            std::vector<int32_t> frames;
+            std::vector<float> xs;
+            std::vector<float> ys;
+            std::vector<int32_t> levels;
+            std::vector<int32_t> types;
+            std::vector<std::string> playerNames;
+            std::vector<NodeId> ids;
+        };
+
+        const int n = treeIds.size();
+
+        auto input = std::make_shared<Input>();
+        auto data = new TreeData();
+
+        data->treeNodes.resize(n);
+        data->treeIds = treeIds;
+
+        input->parents.resize(n);
+        input->players.resize(n, -1);
+        input->frames.resize(n, 0);
+        input->xs.resize(n);
+        input->ys.resize(n);
+        input->levels.resize(n);
+        input->types.resize(n);
+        input->ids = treeIds;
+        for (int i = 0; i < n; ++i) {
+            const auto & node = g_nodes[treeIds[i]];
+
+            // the parent of a node in a chunk can be in a chunk that is not loaded - the node is a root meanwhile
+            const auto itp = g_nodes.find(node.parentId);
+            input->parents[i] = itp != g_nodes.end() ? itp->second.idx : ::ImVid::TreeIndex::kInvalid;
+            input->frames[i] = node.frames;
+
+            // the elements of an unordered_map are not moved on rehash
+            data->treeNodes[i] = &node;
+            input->xs[i] = node.x;
+            input->ys[i] = node.y;
+            input->levels[i] = node.level;
+            input->types[i] = node.type;
+
+            // the username of a command is the player that sent it
+            if (node.type == 2) {
+                const auto res = playerIds.emplace(node.username, (int32_t) playerIds.size());
+                input->players[i] = res.first->second;
+            }
+        }
+
+        input->playerNames.resize(playerIds.size());
+        for (const auto & [name, id] : playerIds) {
+            input->playerNames[id] = name;
+        }
+
+        isTreeBuilding = true;
+        treeTasksLeft = 3;
+
+        const auto finish = [this, data]() {
+            if (--treeTasksLeft == 0) {
+                treePending.store(data);
+            }
+        };
+
+        workerPool.submit([this, input, data, finish]() {
+            if (data->treeIndex.build(input->parents) == false) {
+                fprintf(stderr, "Error: failed to build the tree index\n");
+                treeAggregatesBuilder.clear();
+            } else {
+                treeAggregatesBuilder.update(data->treeIndex, input->players, input->frames);
+            }
+            data->treeAggregates = treeAggregatesBuilder;
+
+            finish();
+        });
+
+        workerPool.submit([input, data, finish]() {
+            if (data->levelLayout.build(input->xs, input->ys, input->levels, input->types, input->parents) == false) {
+                fprintf(stderr, "Error: failed to build the level layout\n");
+            }
+
+            for (int i = 0; i < (int) input->xs.size(); ++i) {
+                data->bbxmin = std::min(data->bbxmin, input->xs[i]);
+                data->bbxmax = std::max(data->bbxmax, input->xs[i]);
+                data->bbymin = std::min(data->bbymin, input->ys[i]);
+                data->bbymax = std::max(data->bbymax, input->ys[i]);
+            }
+
+            finish();
+        });
+
+        workerPool.submit([input, data, finish]() {
+            data->searchIndex.build(input->playerNames, input->players, input->ids);
+
+            finish();
+        });
+    }
+
+    // swaps in the structures of a finished rebuild, returns false if there is none
+    bool applyTreeData() {
+        std::unique_ptr<TreeData> data(treePending.exchange(nullptr));
+        if (data == nullptr) return false;
+
+        std::swap(tree, data);
+
+        bbxmin = std::min(bbxmin, tree->bbxmin);
+        bbxmax = std::max(bbxmax, tree->bbxmax);
+        bbymin = std::min(bbymin, tree->bbymin);
+        bbymax = std::max(bbymax, tree->bbymax);
+
+        isTreeBuilding = false;
+        isPathValid = false;
+
+        search(searchQuery);
+
+        return true;
+    }
+
+    // ids if the query starts with a digit, otherwise player names (an optional '@' is ignored)
+    void search(const std::string & query) {
+        searchQuery = query;
+        searchResults.clear();
+        searchTotal = 0;
+        searchCur = -1;
+
+        const auto pos = query.find_first_not_of(" @");
+        if (pos == std::string::npos) return;
+
+        const auto prefix = query.substr(pos);
+        if (std::isdigit((unsigned char) prefix[0])) {
+            searchTotal = tree->searchIndex.findId(prefix, searchResults, kSearchMaxResults);
+        } else {
+            searchTotal = tree->searchIndex.findName(prefix, searchResults, kSearchMaxResults);
+        }
+    }
+
+    void searchNext(int dir) {
+        const int n = searchResults.size();
+        if (n == 0) return;
+
+        if (searchCur < 0) {
+            searchCur = dir > 0 ? 0 : n - 1;
+        } else {
+            searchCur = (searchCur + dir + n) % n;
+        }
+
+        focusNode(tree->treeIds[searchResults[searchCur]], false);
+    }
+
+    // index of a node in the current tree, kInvalid if it is not in the tree
+    // nodes added after the last rebuild are not in it yet, and evicted chunks renumber the nodes
+    ::ImVid::TreeIndex::Index getTreeIndex(const NodeId & id) const {
+        const auto it = g_nodes.find(id);
+        if (it == g_nodes.end()) return ::ImVid::TreeIndex::kInvalid;
+
+        const auto idx = it->second.idx;
+        if (idx < 0 || idx >= (int) tree->treeIds.size() || tree->treeIds[idx] != id) return ::ImVid::TreeIndex::kInvalid;
+
+        return idx;
+    }
+
+    // aggregates of the subtree of a node, nullptr if not available
+    const ::ImVid::TreeAggregates::Stats * getSubtreeStats(const NodeId & id) const {
+        const auto idx = getTreeIndex(id);
+        if (idx == ::ImVid::TreeIndex::kInvalid || idx >= tree->treeAggregates.size()) return nullptr;
+
+        return &tree->treeAggregates.get(idx);
+    }
+
+    // common ancestor of two nodes, 0 if there is none
+    NodeId getCommonAncestor(const NodeId & a, const NodeId & b) const {
+        const auto idxa = getTreeIndex(a);
+        const auto idxb = getTreeIndex(b);
+        if (idxa == ::ImVid::TreeIndex::kInvalid || idxb == ::ImVid::TreeIndex::kInvalid || tree->treeIndex.isValid() == false) return 0;
+
+        const auto idx = tree->treeIndex.getLCA(idxa, idxb);
+        return idx == ::ImVid::TreeIndex::kInvalid ? 0 : tree->treeIds[idx];
+    }
+
+    // rebuild the highlighted path only when the selection or the tree changes
+    void updatePath() {
+        if (isPathValid && pathSelectedId == selectedId && pathMarkedId == markedId) return;
+
+        isPathValid = true;
+        pathSelectedId = selectedId;
+        pathMarkedId = markedId;
+        pathCommonId = 0;
+        pathPoints.clear();
+
+        const auto idxs = getTreeIndex(selectedId);
+        if (idxs == ::ImVid::TreeIndex::kInvalid || tree->treeIndex.isValid() == false || idxs >= tree->treeIndex.size()) return;
+
+        std::vector<::ImVid::TreeIndex::Index> path;
+
+        if (markedId != selectedId) {
+            pathCommonId = getCommonAncestor(selectedId, markedId);
+        }
+
+        if (pathCommonId != 0) {
+            const auto lca = getTreeIndex(pathCommonId);
+
+            tree->treeIndex.getPath(idxs, lca, path);
+            const int n = path.size();
+            tree->treeIndex.getPath(getTreeIndex(markedId), lca, path);
+
+            // second half goes from the common ancestor down to the marked node
+            path.pop_back();
+            std::reverse(path.begin() + n, path.end());
+        } else {
+            tree->treeIndex.getPath(idxs, ::ImVid::TreeIndex::kInvalid, path);
+        }
+
+        pathPoints.reserve(path.size());
+        for (const auto idx : path) {
+            const auto & node = *tree->treeNodes[idx];
+            pathPoints.push_back({ node.x, node.y });
+        }
+
+        // the details of the commands along the path are likely to be looked at next
+        int nPrefetch = 0;
+        for (const auto idx : path) {
+            if (nPrefetch >= kDetailsMaxPrefetch) break;
+
+            const auto & node = *tree->treeNodes[idx];
+            if (node.type != 2) continue;
+
+            g_nodeDetails.request(node.id);
+            ++nPrefetch;
+        }
+    }
+
     inline void focusNode(const NodeId & id, bool zoomOut) {
+        // the node can be in an evicted chunk
+        const auto it = g_nodes.find(id);
+        if (it == g_nodes.end()) return;
+
         focusId = id;
         selectedId = id;
 
-        anim.v1.x = g_nodes[id].x;
-        anim.v1.y = g_nodes[id].y;
+        anim.v1.x = it->second.x;
+        anim.v1.y = it->second.y;
         anim.v1.z = 0.999f;
 
         anim.t0 = rendering.T + 0.0f;
@@ -414,67 +1117,488 @@ struct State {
         anim.v0 = viewCur;
 
         anim.type = zoomOut ? 4 : 3;
+
+        requestRedraw();
     }
 };
 
 State g_state;
 
-void loadData() {
-    const std::string kPath = "../data/";
+// nodes, positions and edges as read from the data files, before they are added to the tree
+struct LoadedData {
+    std::vector<Node> nodes;
+    std::vector<Node> positions;
+    std::vector<Edge> edges;
+};
 
-    printf("Loading data from '%s'\n", kPath.c_str());
+// collects the nodes of a compact snapshot as its chunks arrive - the segments are fed one after the other
+struct SnapshotLoader {
+    ::ImVid::SnapshotDecoder decoder;
+    LoadedData data;
 
-    {
-        int n = 0;
-        const auto fname = kPath + "nodes.dat";
+    void begin() {
+        data = {};
+        decoder.reset([this](const ::ImVid::SnapshotDecoder::Node & node) {
+            Node cur;
+            cur.id = node.id;
+            cur.parentId = node.parentId;
+            cur.username = *node.username;
+            cur.level = node.level;
+            cur.type = node.type;
+            cur.x = node.x;
+            cur.y = node.y;
+            cur.frames = node.frames;
+
+            Node pos;
+            pos.id = node.id;
+            pos.x = node.x;
+            pos.y = node.y;
+
+            if (node.parentId != 0) {
+                data.edges.push_back({ node.id, node.parentId });
+            }
+
+            data.nodes.push_back(std::move(cur));
+            data.positions.push_back(std::move(pos));
+        }, [this](const ::ImVid::SnapshotDecoder::Move & move) {
+            // the records are pushed in index order
+            data.positions[move.index].x = move.x;
+            data.positions[move.index].y = move.y;
+        });
+    }
+
+    bool feed(const uint8_t * chunk, size_t n) {
+        return decoder.feed(chunk, n);
+    }
+
+    // the previous segment has to be complete
+    bool nextSegment() {
+        return decoder.finish() && decoder.beginSegment();
+    }
+
+    // continues from the records saved on an earlier visit instead of decoding the segments they came from
+    bool restore(const uint8_t * saved, size_t n) {
+        data = {};
+        if (decoder.restore(saved, n) == false) {
+            data = {};
+            return false;
+        }
+
+        return true;
+    }
+
+    // all records decoded so far, to be restored later
+    bool save(std::vector<uint8_t> & saved) const {
+        return decoder.save(saved);
+    }
+
+    bool finish() {
+        if (decoder.finish() == false) {
+            data = {};
+            return false;
+        }
+
+        return true;
+    }
+};
+
+SnapshotLoader g_snapshotLoader;
+
+bool loadSnapshot(const std::string & fname, LoadedData & data) {
+    std::ifstream fin(fname, std::ios::binary);
+    if (fin.good() == false) return false;
+
+    g_snapshotLoader.begin();
+
+    std::vector<char> chunk(64*1024);
+    while (fin) {
+        fin.read(chunk.data(), chunk.size());
+        if (g_snapshotLoader.feed((const uint8_t *) chunk.data(), fin.gcount()) == false) break;
+    }
+
+    if (g_snapshotLoader.finish() == false) {
+        fprintf(stderr, "Failed to load '%s'\n", fname.c_str());
+        return false;
+    }
+
+    data = std::move(g_snapshotLoader.data);
+    g_snapshotLoader.data = {};
+
+    printf("Loaded %d entries from '%s'\n", (int) data.nodes.size(), fname.c_str());
+
+    return true;
+}
+
+bool loadDataFiles(const std::string & path, LoadedData & data) {
+    // the files are parsed in parallel and applied in order - positions and edges refer to the nodes
+    auto & nodes = data.nodes;
+    auto & positions = data.positions;
+    auto & edges = data.edges;
+
+    g_state.workerPool.submit([&]() {
+        const auto fname = path + "nodes.dat";
         std::ifstream fin(fname);
-        while (true) {
+        std::string line;
+        while (std::getline(fin, line)) {
+            // the frames column is optional in older data files
             Node cur;
-            fin >> cur.id >> cur.username >> cur.level >> cur.type;
+            std::istringstream ss(line);
+            ss >> cur.id >> cur.username >> cur.level >> cur.type;
 
-            if (fin.eof()) break;
+            if (ss.fail()) continue;
 
-            g_addNode(cur.id, cur.username.c_str(), cur.level, cur.type, 0, 0);
-            ++n;
+            ss >> cur.frames;
+            if (ss.fail()) cur.frames = 0;
+
+            nodes.push_back(std::move(cur));
         }
-        printf("Loaded %d entries from '%s'\n", n, fname.c_str());
+        printf("Loaded %d entries from '%s'\n", (int) nodes.size(), fname.c_str());
         fin.close();
-    }
+    });
 
-    {
-        int n = 0;
-        const auto fname = kPath + "coordinates.dat";
+    g_state.workerPool.submit([&]() {
+        const auto fname = path + "coordinates.dat";
         std::ifstream fin(fname);
         while (true) {
             Node cur;
             fin >> cur.id >> cur.x >> cur.y;
 
-            if (fin.eof()) break;
+            if (fin.eof()) break;
+
+            positions.push_back(std::move(cur));
+        }
+        printf("Loaded %d entries from '%s'\n", (int) positions.size(), fname.c_str());
+        fin.close();
+    });
+
+    g_state.workerPool.submit([&]() {
+        const auto fname = path + "edges.dat";
+        std::ifstream fin(fname);
+        while (true) {
+            Edge cur;
+            fin >> cur.src >> cur.dst;
+
+            if (fin.eof()) break;
+
+            edges.push_back(cur);
+        }
+        printf("Loaded %d entries from '%s'\n", (int) edges.size(), fname.c_str());
+        fin.close();
+    });
+
+    g_state.workerPool.wait();
+
+    return nodes.empty() == false;
+}
+
+// adds the loaded data to the tree
+void applyData(const LoadedData & data) {
+    const auto & nodes = data.nodes;
+    const auto & positions = data.positions;
+    auto edges = data.edges;
+
+    // the dense indices follow the insertion order - insert along a Hilbert curve over the positions, so that
+    // nodes that are close on screen are close in memory. The text files are already written in this order,
+    // the compact snapshot is stored in id order
+    std::vector<int32_t> order;
+    {
+        std::unordered_map<NodeId, int> posIdx;
+        for (int i = 0; i < (int) positions.size(); ++i) {
+            posIdx[positions[i].id] = i;
+        }
+
+        std::vector<float> xs(nodes.size(), 0.0f);
+        std::vector<float> ys(nodes.size(), 0.0f);
+        for (int i = 0; i < (int) nodes.size(); ++i) {
+            const auto it = posIdx.find(nodes[i].id);
+            if (it == posIdx.end()) continue;
+
+            xs[i] = positions[it->second].x;
+            ys[i] = positions[it->second].y;
+        }
+
+        ::ImVid::getCurveOrder(::ImVid::ECurve::Hilbert, xs, ys, order);
+    }
+
+    for (const auto i : order) {
+        const auto & cur = nodes[i];
+        g_addNode(cur.id, cur.username.c_str(), cur.level, cur.type, 0, 0, cur.frames);
+    }
+
+    for (const auto & cur : positions) {
+        g_updateNodePosition(cur.id, cur.x, cur.y);
+    }
+
+    // edges in the order of their child node
+    {
+        std::unordered_map<NodeId, int> rank;
+        for (int k = 0; k < (int) order.size(); ++k) {
+            rank[nodes[order[k]].id] = k;
+        }
+
+        std::stable_sort(edges.begin(), edges.end(), [&](const Edge & a, const Edge & b) {
+            const auto ita = rank.find(a.src);
+            const auto itb = rank.find(b.src);
+            return (ita == rank.end() ? -1 : ita->second) < (itb == rank.end() ? -1 : itb->second);
+        });
+    }
+
+    for (const auto & cur : edges) {
+        g_addEdge(cur.src, cur.dst);
+    }
+}
+
+// loads the spatial chunks of a large tree around the view, on top of the overview that is loaded like a snapshot
+// the page fetches the chunks that update() asks for and passes them to load()
+struct ChunkLoader {
+    ::ImVid::ChunkSet chunks;
+    SnapshotLoader loader;
+
+    // nodes of each loaded chunk and the chunk of each node
+    std::vector<std::vector<NodeId>> chunkNodes;
+    std::unordered_map<NodeId, int> nodeChunk;
+
+    // parents of loaded nodes that are in chunks which are not loaded
+    std::unordered_map<NodeId, NodeId> pendingParents;
+
+    // chunks to remove in the next updatePre(), between rebuilds
+    std::vector<int> toEvict;
+
+    // evicted nodes stay allocated until the tree that refers to them is replaced
+    std::vector<decltype(g_nodes)::node_type> evictedNodes;
+
+    std::vector<int> pinned;
+
+    // the chunk requested for the focused node
+    int focusChunk = -1;
+
+    // view of the last update, for the velocity
+    bool hasLastView = false;
+    float lastT = 0.0f;
+    View lastView;
+
+    bool isEnabled() const { return chunks.size() > 0; }
+
+    bool init() {
+        chunkNodes.clear();
+        nodeChunk.clear();
+        pendingParents.clear();
+        toEvict.clear();
+        pinned.clear();
+        focusChunk = -1;
+        hasLastView = false;
+
+        return chunks.init(kChunksMaxNodes, kChunksMaxInFlight);
+    }
+
+    int add(const std::string & name, float xmin, float ymin, float xmax, float ymax, int nNodes) {
+        const int i = chunks.add({ name, xmin, ymin, xmax, ymax, nNodes });
+        if (i >= 0) chunkNodes.resize(chunks.size());
+
+        return i;
+    }
+
+    void update(std::vector<int> & toLoad) {
+        toLoad.clear();
+        if (isEnabled() == false) return;
+
+        const float T = ImGui::GetTime();
+        const auto & view = g_state.viewCur;
+        const float scale = g_state.getScale(view.z);
+
+        const ::ImVid::ChunkSet::Rect rect = {
+            view.x - 0.5f*g_state.sizex0*scale,
+            view.y - 0.5f*g_state.sizey0*scale,
+            view.x + 0.5f*g_state.sizex0*scale,
+            view.y + 0.5f*g_state.sizey0*scale,
+        };
+
+        float vx = 0.0f;
+        float vy = 0.0f;
+        if (hasLastView && T > lastT) {
+            vx = (view.x - lastView.x)/(T - lastT);
+            vy = (view.y - lastView.y)/(T - lastT);
+        }
+
+        hasLastView = true;
+        lastT = T;
+        lastView = view;
+
+        // the nodes the user is looking at stay loaded
+        for (const auto i : pinned) {
+            chunks.setPinned(i, false);
+        }
+        pinned.clear();
+
+        for (const auto & id : { g_state.selectedId, g_state.focusId, g_state.markedId }) {
+            const auto it = nodeChunk.find(id);
+            if (it == nodeChunk.end()) continue;
+
+            chunks.setPinned(it->second, true);
+            pinned.push_back(it->second);
+        }
+
+        std::vector<int> evicted;
+        chunks.update(rect, vx, vy, toLoad, evicted);
+
+        if (evicted.empty() == false) {
+            toEvict.insert(toEvict.end(), evicted.begin(), evicted.end());
+            g_state.requestRedraw();
+        }
+    }
+
+    bool request(int i) {
+        if (chunks.request(i) == false) return false;
+
+        focusChunk = i;
+
+        return true;
+    }
+
+    bool load(int i, const uint8_t * data, size_t n) {
+        if (i < 0 || i >= chunks.size()) {
+            fprintf(stderr, "Error: unknown chunk %d\n", i);
+            return false;
+        }
+
+        loader.begin();
+        if (loader.feed(data, n) == false || loader.finish() == false) {
+            fprintf(stderr, "Error: failed to decode chunk %d '%s'\n", i, chunks.get(i).name.c_str());
+            chunks.setFailed(i);
+            return false;
+        }
+
+        if (chunks.setLoaded(i) == false) {
+            loader.data = {};
+            return false;
+        }
+
+        // loaded again before the eviction was applied
+        toEvict.erase(std::remove(toEvict.begin(), toEvict.end(), i), toEvict.end());
+
+        auto & ids = chunkNodes[i];
+        ids.clear();
+        for (const auto & node : loader.data.nodes) {
+            ids.push_back(node.id);
+            nodeChunk[node.id] = i;
+        }
+
+        applyData(loader.data);
+
+        for (const auto & edge : loader.data.edges) {
+            if (g_nodes.find(edge.dst) == g_nodes.end()) {
+                pendingParents[edge.src] = edge.dst;
+            }
+        }
+
+        loader.data = {};
+
+        // children from earlier chunks whose parents arrived with this one
+        for (auto it = pendingParents.begin(); it != pendingParents.end(); ) {
+            if (g_nodes.find(it->second) == g_nodes.end()) {
+                ++it;
+                continue;
+            }
+
+            g_addEdge(it->first, it->second);
+            it = pendingParents.erase(it);
+        }
+
+        if (i == focusChunk) {
+            focusChunk = -1;
+            if (g_nodes.find(g_state.focusId) != g_nodes.end()) {
+                g_state.focusNode(g_state.focusId, false);
+            }
+        }
+
+        g_treeChanged();
+
+        return true;
+    }
+
+    bool failed(int i) {
+        return chunks.setFailed(i);
+    }
+
+    // removes the nodes of the evicted chunks - call only between rebuilds, the next one has to be started right after
+    bool evict() {
+        if (toEvict.empty()) return false;
+
+        for (const auto i : toEvict) {
+            for (const auto & id : chunkNodes[i]) {
+                auto node = g_nodes.extract(id);
+                if (node.empty() == false) {
+                    evictedNodes.push_back(std::move(node));
+                }
+
+                nodeChunk.erase(id);
+                pendingParents.erase(id);
+            }
+
+            chunkNodes[i].clear();
+        }
+        toEvict.clear();
+
+        // children of evicted nodes become roots until their parents are loaded again
+        int nEdges = 0;
+        for (int k = 0; k < (int) g_edges.size(); ++k) {
+            const auto edge = g_edges[k];
+
+            const auto it = g_nodes.find(edge.src);
+            if (it == g_nodes.end()) continue;
+
+            if (g_nodes.find(edge.dst) == g_nodes.end()) {
+                it->second.parentId = edge.src;
+                pendingParents[edge.src] = edge.dst;
+                continue;
+            }
+
+            g_edges[nEdges++] = edge;
+        }
+        g_edges.resize(nEdges);
+
+        // renumber the remaining nodes
+        auto & ids = g_state.treeIds;
+        int nIds = 0;
+        for (int k = 0; k < (int) ids.size(); ++k) {
+            const auto it = g_nodes.find(ids[k]);
+            if (it == g_nodes.end()) continue;
 
-            g_updateNodePosition(cur.id, cur.x, cur.y);
-            ++n;
+            it->second.idx = nIds;
+            ids[nIds++] = ids[k];
         }
-        printf("Loaded %d entries from '%s'\n", n, fname.c_str());
-        fin.close();
+        ids.resize(nIds);
+
+        // the indices changed, so the aggregates cannot be updated incrementally
+        g_state.treeAggregatesBuilder.clear();
+
+        printf("Evicted chunks - %d nodes loaded\n", (int) g_nodes.size());
+
+        return true;
     }
 
-    {
-        int n = 0;
-        const auto fname = kPath + "edges.dat";
-        std::ifstream fin(fname);
-        while (true) {
-            Edge cur;
-            fin >> cur.src >> cur.dst;
+    // once the tree without the evicted nodes is applied
+    void releaseEvicted() {
+        evictedNodes.clear();
+    }
+};
 
-            if (fin.eof()) break;
+ChunkLoader g_chunkLoader;
 
-            g_addEdge(cur.src, cur.dst);
-            ++n;
-        }
-        printf("Loaded %d entries from '%s'\n", n, fname.c_str());
-        fin.close();
+void loadData() {
+    const std::string kPath = "../data/";
+
+    printf("Loading data from '%s'\n", kPath.c_str());
+
+    // prefer the compact snapshot, the text files are still written next to it
+    LoadedData data;
+    if (loadSnapshot(kPath + "snapshot.bin", data) == false) {
+        data = {};
+        loadDataFiles(kPath, data);
     }
 
+    applyData(data);
+
     g_treeChanged();
 }
 
@@ -534,66 +1658,142 @@ void renderMain() {
 
     if (g_state.viewCur.z >= g_state.renderingEdgesMinZ) {
 #ifdef USE_LINE_SHADER
-        // shader-based line rendering
-        const float f = scale/g_state.scaleEdges;
-        const float ds = 0.5*(1.0 - f);
-        const float dx = f*(g_state.viewCur.x - g_state.posEdgesX)*g_state.rendering.idx;
-        const float dy = f*(g_state.viewCur.y - g_state.posEdgesY)*g_state.rendering.idy;
-
-        const float x0 = ds + dx;
-        const float x1 = 1.0f - ds + dx;
-
-        const float y0 = ds + dy;
-        const float y1 = 1.0f - ds + dy;
-
-        const float px0 = 0.25 + 0.25*(x0 + x1) - 0.25*(x1 - x0);
-        const float px1 = 0.25 + 0.25*(x0 + x1) + 0.25*(x1 - x0);
-        const float py0 = 0.25 + 0.25*(y0 + y1) - 0.25*(y1 - y0);
-        const float py1 = 0.25 + 0.25*(y0 + y1) + 0.25*(y1 - y0);
-
-        ImGui::SetCursorScreenPos({ 0.0f, 0.0f, });
-        ImGui::Image((void *)(intptr_t) g_state.fboEdges.getIdTex(), ImGui::GetContentRegionAvail(), { px0, py0, }, { px1, py1, });
+        // shader-based line rendering from the cached edge tiles
+        if (g_state.viewCur.z > 0.9f) {
+            const int level = g_state.getEdgeTileLevel(scale);
+            const float tileSize = std::ldexp(float(kEdgeTileSize), level);
+            const auto col = ImGui::ColorConvertFloat4ToU32({ 1.0f, 1.0f, 1.0f, std::min(1.0f, (g_state.viewCur.z - 0.9f)/0.1f) });
+
+            const int tx0 = std::floor(g_state.rendering.xmin/tileSize);
+            const int tx1 = std::floor(g_state.rendering.xmax/tileSize);
+            const int ty0 = std::floor(g_state.rendering.ymin/tileSize);
+            const int ty1 = std::floor(g_state.rendering.ymax/tileSize);
+
+            for (int ty = ty0; ty <= ty1; ++ty) {
+                for (int tx = tx0; tx <= tx1; ++tx) {
+                    const auto p0 = g_state.getRenderPosition(tx*tileSize, ty*tileSize);
+                    const auto p1 = g_state.getRenderPosition((tx + 1)*tileSize, (ty + 1)*tileSize);
+
+                    // while the tile is not rendered yet, use the part of a coarser one that covers it
+                    for (int i = 0; i < kEdgeTileMaxFallbackLevels; ++i) {
+                        const int n = 1 << i;
+                        const ::ImVid::TileCache::Key key = { level + i, floorDiv(tx, n), floorDiv(ty, n), };
+                        const auto fbo = g_state.tilesEdges.get(key);
+                        if (fbo == nullptr || fbo->isAllocated() == false) continue;
+
+                        const float u0 = float(tx - key.x*n)/n;
+                        const float v0 = float(ty - key.y*n)/n;
+
+                        drawList->AddImage((void *)(intptr_t) fbo->getIdTex(), p0, p1, { u0, v0, }, { u0 + 1.0f/n, v0 + 1.0f/n, }, col);
+                        break;
+                    }
+                }
+            }
+        }
 #else
         // imgui line rendering
         const auto thickness = std::max(0.1, 2.0*iscale);
 
-        for (const auto & edge : g_edges) {
-            const auto col = (edge.src == g_state.selectedId || edge.dst == g_state.selectedId) ?  kColorEdgeSelected : kColorEdge;
+        // edges that come within 1000 pixels of the screen
+        const auto cull = g_state.getWorldSize(1000.0f);
 
-            const auto p0 = g_state.getRenderPosition(g_nodes[edge.src]);
-            const auto p1 = g_state.getRenderPosition(g_nodes[edge.dst]);
+        g_state.getVisibleEdges(
+                g_state.rendering.xmin - cull.x, g_state.rendering.ymin - cull.y,
+                g_state.rendering.xmax + cull.x, g_state.rendering.ymax + cull.y, g_state.visibleEdges);
 
-            const float cull = 1000.0f;
+        auto & edges = g_state.visibleEdges;
+        g_state.getRenderPositions(edges.x0, edges.y0);
+        g_state.getRenderPositions(edges.x1, edges.y1);
 
-            const float pmaxx = std::max(p0.x, p1.x);
-            const float pminx = std::min(p0.x, p1.x);
-            const float pmaxy = std::max(p0.y, p1.y);
-            const float pminy = std::min(p0.y, p1.y);
-
-            if (pmaxx < -cull || pminx > wSize.x + cull ||
-                pmaxy < -cull || pminy > wSize.y + cull) {
-                continue;
+        g_state.drawListParallel.draw(g_state.workerPool, *drawList, edges.size(), [&](ImDrawList & dl, int begin, int end) {
+            for (int i = begin; i < end; ++i) {
+                dl.AddLine({ edges.x0[i], edges.y0[i] }, { edges.x1[i], edges.y1[i] }, kColorEdge, thickness);
             }
+        });
+        g_state.statsNumEdgesRendered += edges.size();
+#endif
+    }
 
-            drawList->AddLine(p0, p1, col, thickness);
-            g_state.statsNumEdgesRendered++;
+    // highlighted path of the selected node
+    g_state.updatePath();
+    if (g_state.pathPoints.size() > 1) {
+        auto & points = g_state.pathPointsRender;
+        points.resize(g_state.pathPoints.size());
+        for (int i = 0; i < (int) points.size(); ++i) {
+            points[i] = g_state.getRenderPosition(g_state.pathPoints[i].x, g_state.pathPoints[i].y);
         }
-#endif
+
+        drawList->AddPolyline(points.data(), points.size(), kColorEdgeSelected, false, std::max(1.0, 3.0*iscale));
     }
 
     ImGui::SetWindowFontScale(1.0f*iscale/kFontScale);
     g_state.rendering.textHScaled = ImGui::CalcTextSize("X").y;
 
+#ifdef USE_GPU_PICKING
+    // on click, the visible nodes and commands are collected and resolved with a single id pass
+    const bool isPicking =
+        g_state.viewCur.z > 0.90 &&
+        g_state.isPopupOpen == false &&
+        g_state.isMouseInMainCanvas() &&
+        ImGui::IsMouseReleased(0) &&
+        g_state.isPanning == false &&
+        isAnimating == false &&
+        g_state.windowShow == false;
+
+    g_state.pickClear();
+#endif
+
     // render nodes
     {
         if (g_state.viewCur.z > 0.900f) {
             drawList->PushTextureID((void *)(intptr_t) g_state.assets.getTexId(::ImVid::Assets::ICON_T2D_SMALL_BLUR));
         }
 
-        for (const auto & [id, node] : g_nodes) {
-            if (node.type == 2) continue;
+        const auto margin = g_state.getWorldSize(2.0f*g_state.getRenderRadiusMax());
+
+        g_state.getVisibleItems(false,
+                g_state.rendering.xmin - margin.x, g_state.rendering.ymin - margin.y,
+                g_state.rendering.xmax + margin.x, g_state.rendering.ymax + margin.y,
+                g_state.visibleItems, g_state.visibleX, g_state.visibleY);
+        g_state.getRenderPositions(g_state.visibleX, g_state.visibleY);
+
+        // zoomed out, the nodes are plain primitives without interaction and are drawn on the worker pool
+        // the root icon and the selection of the focused node stay on this thread
+        const bool isZoomedOut = g_state.viewCur.z <= 0.900f;
+        if (isZoomedOut) {
+            std::atomic<int> nRendered { 0 };
+            g_state.drawListParallel.draw(g_state.workerPool, *drawList, g_state.visibleItems.size(), [&](ImDrawList & dl, int begin, int end) {
+                int n = 0;
+                for (int i = begin; i < end; ++i) {
+                    const auto & node = *g_state.visibleItems[i];
+                    if (node.type == 0) continue;
+
+                    const ImVec2 pos = { g_state.visibleX[i], g_state.visibleY[i] };
+                    const auto radius = g_state.getRenderRadius(node);
+
+                    if (pos.x < -2.0*radius || pos.x > wSize.x + 2.0*radius) continue;
+                    if (pos.y < -2.0*radius || pos.y > wSize.y + 2.0*radius) continue;
+
+                    if (g_state.viewCur.z > 0.500f) {
+                        dl.AddCircleFilled(pos, radius, kColorNode);
+                    } else {
+                        dl.AddRectFilled({ float(pos.x - radius), float(pos.y - radius) }, { float(pos.x + radius), float(pos.y + radius) }, kColorNode);
+                    }
+                    ++n;
+                }
+                nRendered += n;
+            });
+            g_state.statsNumNodesRendered += nRendered;
+        }
+
+        for (int i = 0; i < (int) g_state.visibleItems.size(); ++i) {
+            const auto & node = *g_state.visibleItems[i];
+            const auto & id = node.id;
+
+            const bool isDrawn = isZoomedOut && node.type != 0;
+            if (isDrawn && (g_state.doSelect == false || g_state.focusId != id)) continue;
 
-            const auto pos = g_state.getRenderPosition(node);
+            const ImVec2 pos = { g_state.visibleX[i], g_state.visibleY[i] };
             const auto radius = g_state.getRenderRadius(node);
 
             if (pos.x < -2.0*radius || pos.x > wSize.x + 2.0*radius) continue;
@@ -604,22 +1804,28 @@ void renderMain() {
             const ImVec2 h0 = { pos.x - 2.0f*radius, pos.y - 2.0f*radius };
             const ImVec2 h1 = { pos.x + 2.0f*radius, pos.y + 2.0f*radius };
 
-            if (node.type == 0) {
+            if (isDrawn) {
+                // already drawn on the worker pool
+            } else if (node.type == 0) {
                 const float w = (1.8f*radius);
                 const float h = (3.2f*radius);
 
+                const auto uv = g_state.assets.getUV(::ImVid::Assets::ICON_T2D_BIG);
+
                 ImGui::SetCursorScreenPos({ pos.x - w, pos.y - h, });
-                ImGui::Image((void *)(intptr_t) g_state.assets.getTexId(::ImVid::Assets::ICON_T2D_BIG), { 2.0f*w, 2.0f*h });
+                ImGui::Image((void *)(intptr_t) g_state.assets.getTexId(::ImVid::Assets::ICON_T2D_BIG), { 2.0f*w, 2.0f*h }, { uv.u0, uv.v0 }, { uv.u1, uv.v1 });
             } else {
                 if (g_state.viewCur.z > 0.900f) {
                     const float w = (1.0f*radius);
                     const float h = (1.0f*radius);
 
+                    const auto uv = g_state.assets.getUV(::ImVid::Assets::ICON_T2D_SMALL_BLUR);
+
                     ImGui::SetCursorScreenPos({ pos.x - w, pos.y - h, });
                     if (id == g_state.selectedId) {
-                        ImGui::Image((void *)(intptr_t) g_state.assets.getTexId(::ImVid::Assets::ICON_T2D_SMALL_BLUR), { 2.0f*w, 2.0f*h }, { 0.0f, 0.0f }, { 1.0f, 1.0f }, ImGui::ColorConvertU32ToFloat4(kColorNodeSelected));
+                        ImGui::Image((void *)(intptr_t) g_state.assets.getTexId(::ImVid::Assets::ICON_T2D_SMALL_BLUR), { 2.0f*w, 2.0f*h }, { uv.u0, uv.v0 }, { uv.u1, uv.v1 }, ImGui::ColorConvertU32ToFloat4(kColorNodeSelected));
                     } else {
-                        ImGui::Image((void *)(intptr_t) g_state.assets.getTexId(::ImVid::Assets::ICON_T2D_SMALL_BLUR), { 2.0f*w, 2.0f*h }, { 0.0f, 0.0f }, { 1.0f, 1.0f }, ImGui::ColorConvertU32ToFloat4(kColorNode));
+                        ImGui::Image((void *)(intptr_t) g_state.assets.getTexId(::ImVid::Assets::ICON_T2D_SMALL_BLUR), { 2.0f*w, 2.0f*h }, { uv.u0, uv.v0 }, { uv.u1, uv.v1 }, ImGui::ColorConvertU32ToFloat4(kColorNode));
                     }
                 } else if (g_state.viewCur.z > 0.500f) {
                     drawList->AddCircleFilled(pos, radius, col);
@@ -627,8 +1833,13 @@ void renderMain() {
                     drawList->AddRectFilled({ float(pos.x - radius), float(pos.y - radius) }, { float(pos.x + radius), float(pos.y + radius) }, col);
                 }
             }
-            g_state.statsNumNodesRendered++;
+            g_state.statsNumNodesRendered += isDrawn ? 0 : 1;
 
+#ifdef USE_GPU_PICKING
+            if (isPicking) {
+                g_state.pickAdd(id, pos, h0, h1);
+            }
+#else
             if (g_state.viewCur.z > 0.90 && g_state.isPopupOpen == false) {
                 if (g_state.isMouseInMainCanvas()) {
                     if (ImGui::IsMouseHoveringRect(h0, h1, true)) {
@@ -638,11 +1849,12 @@ void renderMain() {
                             ImGui::OpenPopup("Node");
                             g_state.selectedId = id;
                             g_state.popupShowT0 = T;
-                            g_state.nUpdates = kWindowFadeTime/0.016f + 1.0f;
+                            g_state.requestRedrawFor(kWindowFadeTime);
                         }
                     }
                 }
             }
+#endif
 
             if (g_state.doSelect && g_state.focusId == id && isAnimating == false) {
                 ImGui::SetNextWindowPos({ pos.x + 0.05f*wSize.x, pos.y - std::max(200.0f, 0.25f*wSize.y) });
@@ -650,7 +1862,7 @@ void renderMain() {
                 ImGui::OpenPopup("Node");
                 g_state.selectedId = id;
                 g_state.popupShowT0 = T;
-                g_state.nUpdates = kWindowFadeTime/0.016f + 1.0f;
+                g_state.requestRedrawFor(kWindowFadeTime);
                 g_state.doSelect = false;
             }
         }
@@ -661,10 +1873,54 @@ void renderMain() {
     }
 
     // render commands
-    for (const auto & [id, node] : g_nodes) {
-        if (node.type != 2) continue;
+    {
+        const auto margin = g_state.getWorldSize(2.0f*g_state.getRenderRadiusMax());
+
+        g_state.getVisibleItems(true,
+                g_state.rendering.xmin - margin.x, g_state.rendering.ymin - margin.y,
+                g_state.rendering.xmax + margin.x, g_state.rendering.ymax + margin.y,
+                g_state.visibleItems, g_state.visibleX, g_state.visibleY);
+        g_state.getRenderPositions(g_state.visibleX, g_state.visibleY);
+    }
+
+    // zoomed out, the commands are plain rects without interaction and are drawn on the worker pool
+    const bool isCommandsZoomedOut = g_state.viewCur.z <= 0.900f;
+    if (isCommandsZoomedOut) {
+        // ImGui::CalcTextSize() reads the current window - measure with the font directly, rounded the same way
+        const auto font = ImGui::GetFont();
+        const auto fontSize = ImGui::GetFontSize();
+
+        std::atomic<int> nRendered { 0 };
+        g_state.drawListParallel.draw(g_state.workerPool, *drawList, g_state.visibleItems.size(), [&](ImDrawList & dl, int begin, int end) {
+            int n = 0;
+            for (int i = begin; i < end; ++i) {
+                const auto & node = *g_state.visibleItems[i];
+
+                const ImVec2 pos  = { g_state.visibleX[i], g_state.visibleY[i] };
+                const auto radius = g_state.getRenderRadius(node);
 
-        const auto pos    = g_state.getRenderPosition(node);
+                if (pos.x < -2.0*radius || pos.x > wSize.x + 2.0*radius) continue;
+                if (pos.y < -2.0*radius || pos.y > wSize.y + 2.0*radius) continue;
+
+                const auto col = (node.id == g_state.selectedId) ? kColorCommandSelected : kColorCommand;
+
+                const float textWidth = std::floor(font->CalcTextSizeA(fontSize, FLT_MAX, 0.0f, node.username.c_str()).x + 0.99999f);
+                const auto [ pt, p0, p1 ] = g_state.getRenderCommand(pos, textWidth);
+
+                dl.AddRectFilled(p0, p1, col);
+                ++n;
+            }
+            nRendered += n;
+        });
+        g_state.statsNumCommandsRendered += nRendered;
+    }
+
+    const int nCommandsSerial = isCommandsZoomedOut ? 0 : (int) g_state.visibleItems.size();
+    for (int i = 0; i < nCommandsSerial; ++i) {
+        const auto & node = *g_state.visibleItems[i];
+        const auto & id = node.id;
+
+        const ImVec2 pos  = { g_state.visibleX[i], g_state.visibleY[i] };
         const auto radius = g_state.getRenderRadius(node);
 
         if (pos.x < -2.0*radius || pos.x > wSize.x + 2.0*radius) continue;
@@ -686,6 +1942,11 @@ void renderMain() {
         }
         g_state.statsNumCommandsRendered++;
 
+#ifdef USE_GPU_PICKING
+        if (isPicking) {
+            g_state.pickAdd(id, pos, p0, p1);
+        }
+#else
         if (g_state.viewCur.z > 0.90 && g_state.isPopupOpen == false) {
             if (g_state.isMouseInMainCanvas()) {
                 if (ImGui::IsMouseHoveringRect(p0, p1, true)) {
@@ -695,12 +1956,28 @@ void renderMain() {
                         ImGui::OpenPopup("Node");
                         g_state.selectedId = id;
                         g_state.popupShowT0 = T;
-                        g_state.nUpdates = kWindowFadeTime/0.016f + 1.0f;
+                        g_state.requestRedrawFor(kWindowFadeTime);
                     }
                 }
             }
         }
+#endif
+    }
+
+#ifdef USE_GPU_PICKING
+    if (isPicking) {
+        const int idx = g_state.pick(ImGui::GetIO().MousePos);
+        if (idx >= 0) {
+            const auto & pos = g_state.pickPositions[idx];
+            ImGui::SetNextWindowPos({ pos.x + 0.05f*wSize.x, pos.y - std::max(200.0f, 0.25f*wSize.y) });
+
+            ImGui::OpenPopup("Node");
+            g_state.selectedId = g_state.pickIds[idx];
+            g_state.popupShowT0 = T;
+            g_state.requestRedrawFor(kWindowFadeTime);
+        }
     }
+#endif
 
     if (g_nodes.find(g_state.selectedId) != g_nodes.end()) {
         ImGui::PushFont(ImGui::GetIO().Fonts->Fonts.back());
@@ -759,7 +2036,36 @@ void renderMain() {
             }
             //ImGui::Text("Pos:    %.0f %.0f", node.x, node.y);
             ImGui::Text("Type:   %s", node.type == 0 ? "ROOT" : node.type == 1 ? "Node" : "Command");
+
+            // a node is the result of its parent command
+            const NodeId detailsId = node.type == 2 ? node.id : node.type == 1 ? node.parentId : 0;
+            if (detailsId != 0) {
+                if (const auto details = g_nodeDetails.get(detailsId)) {
+                    if (details->isMissing == false) {
+                        ImGui::Text("Cmd:    %s", details->cmd.c_str());
+                        if ((int) details->input.size() > kDetailsMaxInput) {
+                            ImGui::Text("Input:  %.*s...", kDetailsMaxInput, details->input.c_str());
+                        } else {
+                            ImGui::Text("Input:  %s", details->input.c_str());
+                        }
+                    }
+                } else {
+                    g_nodeDetails.request(detailsId);
+                    ImGui::Text("Cmd:    Loading...");
+                }
+            }
             ImGui::Text("Depth:  %d", node.level);
+            if (const auto stats = g_state.getSubtreeStats(g_state.selectedId)) {
+                ImGui::Text("Below:  %d nodes, %d levels", stats->nNodes - 1, stats->maxDepth - g_state.tree->treeIndex.getDepth(g_state.getTreeIndex(node.id)));
+                ImGui::Text("        %d players, %d max frames", stats->nPlayers, stats->maxFrames);
+            }
+            if (g_state.markedId != 0 && g_state.markedId != g_state.selectedId) {
+                if (g_state.pathCommonId != 0) {
+                    ImGui::Text("Common: %" PRIu64 " (depth %d)", g_state.pathCommonId, g_nodes[g_state.pathCommonId].level);
+                } else {
+                    ImGui::Text("Common: none");
+                }
+            }
             if (g_achievementsMap.find(node.id) != g_achievementsMap.end()) {
                 const auto & achievement = g_achievementsMap[node.id];
                 const auto col = ImGui::ColorConvertU32ToFloat4(kColorNodeSelected);
@@ -795,6 +2101,24 @@ void renderMain() {
                 g_state.focusNode(g_state.selectedId, false);
             }
 
+            // mark a node to highlight the path through the common ancestor with the next selected one
+            ImGui::SameLine();
+            if (g_state.markedId == g_state.selectedId) {
+                if (ImGui::Button("Unmark")) {
+                    g_state.markedId = 0;
+                }
+            } else {
+                if (ImGui::Button("Mark")) {
+                    g_state.markedId = g_state.selectedId;
+                }
+                if (g_state.pathCommonId != 0 && g_state.pathCommonId != g_state.selectedId) {
+                    ImGui::SameLine();
+                    if (ImGui::Button("Common")) {
+                        g_state.focusNode(g_state.pathCommonId, false);
+                    }
+                }
+            }
+
             ImGui::EndPopup();
         } else {
             if (g_state.isPopupOpen) {
@@ -825,7 +2149,7 @@ void renderMain() {
                 g_state.windowShow = true;
                 g_state.windowShowT0 = T;
                 g_state.windowKind = EWindowKind::Help;
-                g_state.nUpdates = kWindowFadeTime/0.016f + 1.0f;
+                g_state.requestRedrawFor(kWindowFadeTime);
             }
         }
 
@@ -839,7 +2163,7 @@ void renderMain() {
                 g_state.windowShow = true;
                 g_state.windowShowT0 = T;
                 g_state.windowKind = EWindowKind::Statistics;
-                g_state.nUpdates = kWindowFadeTime/0.016f + 1.0f;
+                g_state.requestRedrawFor(kWindowFadeTime);
             }
         }
 
@@ -853,7 +2177,21 @@ void renderMain() {
                 g_state.windowShow = true;
                 g_state.windowShowT0 = T;
                 g_state.windowKind = EWindowKind::Achievements;
-                g_state.nUpdates = kWindowFadeTime/0.016f + 1.0f;
+                g_state.requestRedrawFor(kWindowFadeTime);
+            }
+        }
+
+        // search
+        {
+            ImGui::SetCursorScreenPos({ kGridOffset.x + 3.0f*(kGridSize + kGridOffset.x), 1.0f*(kGridSize + kGridOffset.y) - kGridSize, });
+
+            if (ImGui::Button(ICON_FA_SEARCH, ImVec2 { kGridSize, kGridSize })) {
+                ImGui::SetNextWindowPos({ kGridOffset.x + 0.0f*(kGridSize + kGridOffset.x), 2.0f*(kGridSize + kGridOffset.y) - kGridSize, });
+                ImGui::SetNextWindowFocus();
+                g_state.windowShow = true;
+                g_state.windowShowT0 = T;
+                g_state.windowKind = EWindowKind::Search;
+                g_state.requestRedrawFor(kWindowFadeTime);
             }
         }
 
@@ -986,7 +2324,9 @@ void renderMain() {
                     "\n\n");
 
         {
-            ImGui::Image((void *)(intptr_t) g_state.assets.getTexId(::ImVid::Assets::ICON_T2D_SMALL_BLUR), { kIconSize, kIconSize, }, { 0.0f, 0.0f }, { 1.0f, 1.0f }, ImGui::ColorConvertU32ToFloat4(kColorNode));
+            const auto uv = g_state.assets.getUV(::ImVid::Assets::ICON_T2D_SMALL_BLUR);
+
+            ImGui::Image((void *)(intptr_t) g_state.assets.getTexId(::ImVid::Assets::ICON_T2D_SMALL_BLUR), { kIconSize, kIconSize, }, { uv.u0, uv.v0 }, { uv.u1, uv.v1 }, ImGui::ColorConvertU32ToFloat4(kColorNode));
             ImGui::SameLine();
             ImGui::Text("- Node");
         }
@@ -1037,13 +2377,17 @@ void renderMain() {
 
         ImGui::Text("Total nodes:    %d\n", (int) g_nodes.size());
         ImGui::Text("Unique players: %d\n", g_state.statsNumUniquePlayers);
+        if (const auto stats = g_state.getSubtreeStats(g_state.rootId)) {
+            ImGui::Text("Max depth:      %d\n", stats->maxDepth);
+            ImGui::Text("Max frames:     %d\n", stats->maxFrames);
+        }
 
         ImGui::Separator();
         ImGui::TextDisabled("Rendering info");
         ImGui::Separator();
         ImGui::Text("Zoom:      %.5f", g_state.viewCur.z);
         ImGui::Text("Mouse:     %.0f %.0f", std::max(0.0f, ImGui::GetIO().MousePos.x), std::max(0.0f, ImGui::GetIO().MousePos.y));
-        ImGui::Text("Framerate: %.2f (%d, %.3f)", ImGui::GetIO().Framerate, g_state.nUpdates, T);
+        ImGui::Text("Framerate: %.2f (%d, %.3f)", ImGui::GetIO().Framerate, g_state.nRedrawFrames, T);
         ImGui::Text("Display:   %.0f %.0f", ImGui::GetIO().DisplaySize.x, ImGui::GetIO().DisplaySize.y);
         ImGui::Text("Nodes:     %d", g_state.statsNumNodesRendered);
         ImGui::Text("Commands:  %d", g_state.statsNumCommandsRendered);
@@ -1119,6 +2463,49 @@ void renderMain() {
         ImGui::End();
     }
 
+    // window : Search
+    if (g_state.windowShow && g_state.windowKind == EWindowKind::Search) {
+        ImGui::Begin("Search", nullptr,
+                     ImGuiWindowFlags_NoMove |
+                     ImGuiWindowFlags_NoResize |
+                     ImGuiWindowFlags_NoCollapse |
+                     ImGuiWindowFlags_NoScrollbar |
+                     ImGuiWindowFlags_AlwaysAutoResize);
+        ImGui::GetStyle().Alpha = std::min(1.0f, (T - g_state.windowShowT0)/kWindowFadeTime);
+        ImGui::SetWindowFontScale(1.0f/kFontScale);
+
+        if (ImGui::IsWindowAppearing()) {
+            ImGui::SetKeyboardFocusHere();
+        }
+
+        // the buffer is updated on every keystroke - enter jumps to the next match
+        ImGui::SetNextItemWidth(std::min(0.65f*ImGui::GetIO().DisplaySize.x, 300.0f));
+        const bool isEnter = ImGui::InputTextWithHint("##search", "player or tweet id", g_state.searchText, sizeof(g_state.searchText), ImGuiInputTextFlags_EnterReturnsTrue);
+        if (g_state.searchQuery != g_state.searchText) {
+            g_state.search(g_state.searchText);
+        }
+        if (isEnter) {
+            g_state.searchNext(1);
+            ImGui::SetKeyboardFocusHere(-1);
+        }
+
+        if (ImGui::Button(ICON_FA_ARROW_LEFT)) {
+            g_state.searchNext(-1);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button(ICON_FA_ARROW_RIGHT)) {
+            g_state.searchNext(1);
+        }
+        ImGui::SameLine();
+        if (g_state.searchTotal > (int) g_state.searchResults.size()) {
+            ImGui::Text("%d / %d (%d total)", g_state.searchCur + 1, (int) g_state.searchResults.size(), g_state.searchTotal);
+        } else {
+            ImGui::Text("%d / %d", g_state.searchCur + 1, g_state.searchTotal);
+        }
+
+        ImGui::End();
+    }
+
     ImGui::PopFont();
     ImGui::GetStyle().Alpha = 1.0f;
 
@@ -1132,48 +2519,58 @@ void renderMain() {
     ImGui::EndFrame();
 }
 
-bool interp(float & x, float x0, float x1, float t0, float t1, float t, int type, bool isZoom) {
-    if (x == x1 && type != 4) return false;
-    if (t < t0) {
-        x = x0;
-        return true;
-    }
-    if (t >= t1) {
-        x = x1;
-        return true;
-    }
+#ifdef USE_LINE_SHADER
+void renderEdgeTile(const ::ImVid::TileCache::Key & key, ::ImVid::FrameBuffer & fbo) {
+    if (fbo.isAllocated() == false) return;
 
-    float f = (t - t0)/(t1 - t0);
-    if (type == 1) {
-        x = x0 + (x1 - x0)*std::pow(f, 4);
-    } else if (type == 2) {
-        x = x0 + (x1 - x0)*std::pow(f, 0.5);
-    } else if (type == 3) {
-        x = x0 + (x1 - x0)*(f*f*(3.0f - 2.0f*f));
-    } else if (type == 4) {
-        if (isZoom) {
-            if (f < 0.5f) {
-                f = 2.0f*f;
-                x = x0 + (0.1f - x0)*(f*f*(3.0f - 2.0f*f));
-            } else {
-                f = 2.0f*(f - 0.5f);
-                x = 0.1f + (x1 - 0.1f)*(f*f*(3.0f - 2.0f*f));
-            }
-        } else {
-            x = x0 + (x1 - x0)*(f*f*(3.0f - 2.0f*f));
-        }
-    } else {
-        // linear
-        x = x0 + ((x1 - x0)/(t1 - t0))*(t - t0);
+    const float tileSize = std::ldexp(float(kEdgeTileSize), key.level);
+    const float itileSize = 1.0f/tileSize;
+
+    const float x0 = key.x*tileSize;
+    const float y0 = key.y*tileSize;
+    const float x1 = x0 + tileSize;
+    const float y1 = y0 + tileSize;
+
+    // constant thickness in world units, i.e. thicker in texels on the finer levels
+    const float thickness = std::max(0.5f, std::ldexp(2.0f, -key.level));
+    const float margin = 2.0f*thickness*tileSize/kEdgeTileSize;
+
+    const std::array<float, 4> col = { float(0x1D)/256.0f, float(0xA1)/256.0f, float(0xF2)/256.0f, 0.5f };
+
+    Segments edges;
+    g_state.getVisibleEdges(x0 - margin, y0 - margin, x1 + margin, y1 + margin, edges);
+
+    // world -> [-1, 1] over the tile
+    const int n = edges.size();
+    const float xc = x0 + 0.5f*tileSize;
+    const float yc = y0 + 0.5f*tileSize;
+    ::ImVid::transformPoints(n, edges.x0.data(), edges.y0.data(), xc, yc, 2.0f*itileSize, 2.0f*itileSize, edges.x0.data(), edges.y0.data());
+    ::ImVid::transformPoints(n, edges.x1.data(), edges.y1.data(), xc, yc, 2.0f*itileSize, 2.0f*itileSize, edges.x1.data(), edges.y1.data());
+
+    std::vector<std::array<float, 2>> points(2*n);
+    for (int i = 0; i < n; ++i) {
+        points[2*i + 0] = { edges.x0[i], edges.y0[i] };
+        points[2*i + 1] = { edges.x1[i], edges.y1[i] };
     }
 
-    return true;
+    fbo.bind();
+    fbo.clear();
+    fbo.unbind();
+
+    g_state.shaderEdges.renderLinesAsQuads(fbo, col, points, thickness);
 }
+#endif
 
 void updatePre() {
     const float T = ImGui::GetTime();
 
-    if (g_state.treeChanged) {
+    // the rebuild without the evicted chunks starts right away
+    if (g_state.isTreeBuilding == false && g_chunkLoader.evict()) {
+        g_state.treeChanged = true;
+    }
+
+    // changes that arrive during a rebuild are picked up once it is applied
+    if (g_state.treeChanged && g_state.isTreeBuilding == false) {
         for (auto & [src, dst] : g_edges) {
             g_nodes[src].parentId = dst;
         }
@@ -1184,7 +2581,8 @@ void updatePre() {
                 printf("Root node: %" PRIu64 " %g %g\n", id, node.x, node.y);
             }
 
-            if (node.level < 1) {
+            // the chunks of a large tree arrive one by one - move the root only once
+            if (node.level < 1 && g_state.isFirstChange) {
                 node.y -= 200;
             }
 
@@ -1193,11 +2591,20 @@ void updatePre() {
             //}
         }
 
-        for (const auto & [id, node] : g_nodes) {
-            if (node.x < g_state.bbxmin) g_state.bbxmin = node.x;
-            if (node.x > g_state.bbxmax) g_state.bbxmax = node.x;
-            if (node.y < g_state.bbymin) g_state.bbymin = node.y;
-            if (node.y > g_state.bbymax) g_state.bbymax = node.y;
+        g_state.buildTreeIndex();
+        g_state.treeChanged = false;
+    }
+
+    // keep the main loop running until the workers are done
+    if (g_state.isTreeBuilding) {
+        g_state.requestRedraw();
+    }
+
+    if (g_state.applyTreeData()) {
+        g_chunkLoader.releaseEvicted();
+
+        if (const auto stats = g_state.getSubtreeStats(g_state.rootId)) {
+            g_state.statsNumUniquePlayers = stats->nPlayers;
         }
 
         g_state.onWindowResize();
@@ -1235,23 +2642,15 @@ void updatePre() {
                 g_achievementsMap[achievement.id] = achievement;
             }
 
-            {
-                std::set<std::string> seen;
-                for (const auto & node : g_nodes) {
-                    if (seen.find(node.second.username) == seen.end()) {
-                        seen.emplace(node.second.username);
-                        g_state.statsNumUniquePlayers++;
-                    }
-                }
-            }
-
             g_state.isFirstChange = false;
         }
 
+#ifdef USE_LINE_SHADER
+        g_state.tilesEdges.clear();
+#endif
+
         printf("Bounding box: [%g %g -> %g %g]\n", g_state.bbxmin, g_state.bbymin, g_state.bbxmax, g_state.bbymax);
         printf("Scene scale:  %g\n", g_state.sceneScale);
-
-        g_state.treeChanged = false;
     }
 
 #ifdef USE_LINE_SHADER
@@ -1260,6 +2659,17 @@ void updatePre() {
             fprintf(stderr, "Error: Failed to create line shader!\n");
             throw 1;
         }
+
+        g_state.tilesEdges.init(kEdgeTileSize, kEdgeTileCacheSize);
+    }
+#endif
+
+#ifdef USE_GPU_PICKING
+    if (g_state.shaderPick.isValid() == false) {
+        if (g_state.shaderPick.createIdRender() == false) {
+            fprintf(stderr, "Error: Failed to create id shader!\n");
+            throw 1;
+        }
     }
 #endif
 
@@ -1276,10 +2686,15 @@ void updatePre() {
         {
             const auto & keyMap = ImGui::GetIO().KeyMap;
 
-            if (ImGui::IsKeyDown(keyMap[ImGuiKey_LeftArrow]))  { vt.x -= kStepPos*scale; newAnim = true; }
-            if (ImGui::IsKeyDown(keyMap[ImGuiKey_RightArrow])) { vt.x += kStepPos*scale; newAnim = true; }
-            if (ImGui::IsKeyDown(keyMap[ImGuiKey_UpArrow]))    { vt.y -= kStepPos*scale; newAnim = true; }
-            if (ImGui::IsKeyDown(keyMap[ImGuiKey_DownArrow]))  { vt.y += kStepPos*scale; newAnim = true; }
+            // keys go to the text field while typing a search
+            const bool isTyping = ImGui::GetIO().WantTextInput;
+
+            if (isTyping == false) {
+                if (ImGui::IsKeyDown(keyMap[ImGuiKey_LeftArrow]))  { vt.x -= kStepPos*scale; newAnim = true; }
+                if (ImGui::IsKeyDown(keyMap[ImGuiKey_RightArrow])) { vt.x += kStepPos*scale; newAnim = true; }
+                if (ImGui::IsKeyDown(keyMap[ImGuiKey_UpArrow]))    { vt.y -= kStepPos*scale; newAnim = true; }
+                if (ImGui::IsKeyDown(keyMap[ImGuiKey_DownArrow]))  { vt.y += kStepPos*scale; newAnim = true; }
+            }
 
             if (g_state.isMouseInMainCanvas()) {
                 if (ImGui::IsMouseDown(0) && g_state.isPinching == false && g_state.isPopupOpen == false && g_state.windowShow == false) {
@@ -1319,8 +2734,8 @@ void updatePre() {
             }
 
             {
-                if (ImGui::IsKeyDown(SDL_SCANCODE_Q)) { vt.z += 0.3f*(1.001f - g_state.viewCur.z); newAnim = true; }
-                if (ImGui::IsKeyDown(SDL_SCANCODE_A)) { vt.z -= 0.3f*(1.001f - g_state.viewCur.z); newAnim = true; }
+                if (isTyping == false && ImGui::IsKeyDown(SDL_SCANCODE_Q)) { vt.z += 0.3f*(1.001f - g_state.viewCur.z); newAnim = true; }
+                if (isTyping == false && ImGui::IsKeyDown(SDL_SCANCODE_A)) { vt.z -= 0.3f*(1.001f - g_state.viewCur.z); newAnim = true; }
 
                 const float mwheel = std::max(-5.0f, std::min(5.0f, ImGui::GetIO().MouseWheel));
 
@@ -1356,7 +2771,7 @@ void updatePre() {
                 g_state.anim.v1 = vt;
                 g_state.anim.type = 2;
 
-                g_state.nUpdates = std::max(1, g_state.nUpdates);
+                g_state.requestRedraw();
             }
 
             //printf("%g %g\n", g_state.viewCur.z, g_state.zoomTgt);
@@ -1364,84 +2779,48 @@ void updatePre() {
 
         g_state.anim.v1.z = std::max(kZoomMin, std::min(kZoomMax, g_state.anim.v1.z));
 
-        g_state.isMoving  |= interp(g_state.viewCur.x, g_state.anim.v0.x, g_state.anim.v1.x, g_state.anim.t0, g_state.anim.t1, T, g_state.anim.type, false);
-        g_state.isMoving  |= interp(g_state.viewCur.y, g_state.anim.v0.y, g_state.anim.v1.y, g_state.anim.t0, g_state.anim.t1, T, g_state.anim.type, false);
-        g_state.isZooming |= interp(g_state.viewCur.z, g_state.anim.v0.z, g_state.anim.v1.z, g_state.anim.t0, g_state.anim.t1, T, g_state.anim.type, true);
+        g_state.isMoving  |= ::ImVid::interp(g_state.viewCur.x, g_state.anim.v0.x, g_state.anim.v1.x, g_state.anim.t0, g_state.anim.t1, T, g_state.anim.type, false);
+        g_state.isMoving  |= ::ImVid::interp(g_state.viewCur.y, g_state.anim.v0.y, g_state.anim.v1.y, g_state.anim.t0, g_state.anim.t1, T, g_state.anim.type, false);
+        g_state.isZooming |= ::ImVid::interp(g_state.viewCur.z, g_state.anim.v0.z, g_state.anim.v1.z, g_state.anim.t0, g_state.anim.t1, T, g_state.anim.type, true);
     }
 
-    const float scale = g_state.getScale(g_state.viewCur.z);
-    [[maybe_unused]] const float iscale = (1.0/scale)/ImGui::GetIO().DisplayFramebufferScale.x;
+    [[maybe_unused]] const float scale = g_state.getScale(g_state.viewCur.z);
 
 #ifdef USE_LINE_SHADER
-    const float xmin = g_state.viewCur.x - 0.5*g_state.sizex0*scale;
-    const float ymin = g_state.viewCur.y - 0.5*g_state.sizey0*scale;
-    const float xmax = g_state.viewCur.x + 0.5*g_state.sizex0*scale;
-    const float ymax = g_state.viewCur.y + 0.5*g_state.sizey0*scale;
-
-    const float idx = 1.0f/(xmax - xmin);
-    const float idy = 1.0f/(ymax - ymin);
-
-    if (
-            g_state.forceRender ||
-            (
-                    (g_state.viewCur.z > 0.9f) &&
-                    (
-                            ((g_state.isZooming || g_state.isMoving) && g_state.nSkipUpdate-- <= 0) ||
-                            (g_state.isZooming == false && g_state.isMoving == false && (g_state.wasMoving || g_state.wasZooming))
-                    )
-            )
-       ) {
-
-        //printf("%d %d %d %d\n", g_state.isMoving, g_state.isZooming, g_state.wasMoving, g_state.wasZooming);
-
-        auto & fbo = g_state.fboEdges;
-        auto & shader = g_state.shaderEdges;
-
-        if (fbo.isAllocated() == false) {
-            fbo.create(4*1024, 4*1024);
+    // render the edge tiles that became visible - a few per frame, the rest in the following frames
+    if (g_state.viewCur.z > 0.9f) {
+        const float xmin = g_state.viewCur.x - 0.5*g_state.sizex0*scale;
+        const float ymin = g_state.viewCur.y - 0.5*g_state.sizey0*scale;
+        const float xmax = g_state.viewCur.x + 0.5*g_state.sizex0*scale;
+        const float ymax = g_state.viewCur.y + 0.5*g_state.sizey0*scale;
+
+        const int level = g_state.getEdgeTileLevel(scale);
+        const float tileSize = std::ldexp(float(kEdgeTileSize), level);
+
+        // otherwise the visible tiles evict each other and are rendered again in every frame
+        const int nTilesMax = g_state.getEdgeTileCacheSize();
+        if (g_state.tilesEdges.getMaxTiles() != nTilesMax) {
+            g_state.tilesEdges.setMaxTiles(nTilesMax);
         }
 
-        if (fbo.isAllocated()) {
-            fbo.bind();
-            fbo.clear();
-            fbo.unbind();
-
-            const std::array<float, 4> col = { float(0x1D)/256.0f, float(0xA1)/256.0f, float(0xF2)/256.0f, float(0.5f*(g_state.viewCur.z - 0.9f)/0.1f) };
-            const auto thickness = std::max(0.25, 2.0*iscale);
-
-            std::vector<std::array<float, 2>> points;
+        int nRendered = 0;
+        for (int ty = std::floor(ymin/tileSize); ty <= std::floor(ymax/tileSize); ++ty) {
+            for (int tx = std::floor(xmin/tileSize); tx <= std::floor(xmax/tileSize); ++tx) {
+                const ::ImVid::TileCache::Key key = { level, tx, ty, };
+                if (g_state.tilesEdges.get(key)) continue;
 
-            for (const auto & edge : g_edges) {
-                const ImVec2 p0 = {
-                    1.0f*(g_nodes[edge.src].x - xmin)*idx - 0.5f,
-                    1.0f*(g_nodes[edge.src].y - ymin)*idy - 0.5f,
-                };
-
-                const ImVec2 p1 = {
-                    1.0f*(g_nodes[edge.dst].x - xmin)*idx - 0.5f,
-                    1.0f*(g_nodes[edge.dst].y - ymin)*idy - 0.5f,
-                };
+                if (nRendered >= kEdgeTileMaxRendersPerFrame) {
+                    g_state.requestRedraw();
+                    continue;
+                }
 
-                points.push_back({ p0.x, p0.y });
-                points.push_back({ p1.x, p1.y });
+                renderEdgeTile(key, *g_state.tilesEdges.insert(key));
+                ++nRendered;
             }
-
-            shader.renderLinesAsQuads(fbo, col, points, thickness);
-
-            g_state.posEdgesX = g_state.viewCur.x;
-            g_state.posEdgesY = g_state.viewCur.y;
-            g_state.scaleEdges = scale;
-            g_state.nSkipUpdate = 10;
         }
-
-        g_state.forceRender = false;
     }
 #endif
 
-    if (g_state.isMoving || g_state.isZooming) {
-        g_state.nUpdates = std::max(1, g_state.nUpdates);
-    }
-
     if (T >= g_state.anim.t1) {
         g_state.anim.v1 = g_state.viewCur;
     }
@@ -1453,6 +2832,8 @@ void updatePost() {
 }
 
 void deinitMain() {
+    g_state.workerPool.free();
+    delete g_state.treePending.exchange(nullptr);
 }
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
@@ -1491,46 +2872,75 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
 
     // loading assets and fonts
 
+    ::ImVid::BakedAssets baked;
+    {
 #ifdef __EMSCRIPTEN__
-        g_state.assets.load(".");
+        const std::string fnameAssets = "explorer.assets";
 #else
-        g_state.assets.load("../images");
+        const std::string fnameAssets = getBinaryPath() + "t2d-explorer-assets/explorer.assets";
 #endif
-
-    {
-        bool isNotLoaded = true;
-        const bool merge = false;
-        const float fontSize = 14.0f*kFontScale;
-        const char * fontName = "DroidSans.ttf";
-        isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + fontName, fontSize, merge);
-        isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../../fonts/" + fontName, fontSize, merge);
-        isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../bin/" + fontName, fontSize, merge);
-        isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../examples/assets/fonts/" + fontName, fontSize, merge);
-        isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../../examples/assets/fonts/" + fontName, fontSize, merge);
+        if (baked.read(fnameAssets.c_str())) {
+            g_state.assets.load(baked.icons);
+        }
     }
 
-    {
-        bool isNotLoaded = true;
-        const bool merge = true;
-        const float fontSize = 14.0f*kFontScale;
-        const char * fontName = "fontawesome-webfont.ttf";
-        isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + fontName, fontSize, merge);
-        isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../../fonts/" + fontName, fontSize, merge);
-        isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../bin/" + fontName, fontSize, merge);
-        isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../examples/assets/fonts/" + fontName, fontSize, merge);
-        isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../../examples/assets/fonts/" + fontName, fontSize, merge);
-    }
-
-    ImFontConfig cfg;
-    cfg.SizePixels = 13.0f*kFontScale;
-    //cfg.OversampleH = 3;
-    ImGui::GetIO().Fonts->AddFontDefault(&cfg);
+    if (ImGui_tryLoadBakedFonts(baked.fonts) == false) {
+#ifdef __EMSCRIPTEN__
+        // the fonts are not preloaded separately - the default font takes the place of the text font
+        fprintf(stderr, "Error: no fonts in the baked assets - using the default font\n");
+        {
+            ImFontConfig cfg;
+            cfg.SizePixels = ::ImVid::BakedFonts::kSizeText;
+            ImGui::GetIO().Fonts->AddFontDefault(&cfg);
+        }
+#else
+        {
+            bool isNotLoaded = true;
+            const bool merge = false;
+            const float fontSize = ::ImVid::BakedFonts::kSizeText;
+            const char * fontName = "DroidSans.ttf";
+            isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + fontName, fontSize, merge);
+            isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../../fonts/" + fontName, fontSize, merge);
+            isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../bin/" + fontName, fontSize, merge);
+            isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../examples/assets/fonts/" + fontName, fontSize, merge);
+            isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../../examples/assets/fonts/" + fontName, fontSize, merge);
+        }
+
+        {
+            bool isNotLoaded = true;
+            const bool merge = true;
+            const float fontSize = ::ImVid::BakedFonts::kSizeText;
+            const char * fontName = "fontawesome-webfont.ttf";
+            isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + fontName, fontSize, merge);
+            isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../../fonts/" + fontName, fontSize, merge);
+            isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../bin/" + fontName, fontSize, merge);
+            isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../examples/assets/fonts/" + fontName, fontSize, merge);
+            isNotLoaded = isNotLoaded && !ImGui_tryLoadFont(getBinaryPath() + "../../examples/assets/fonts/" + fontName, fontSize, merge);
+        }
+#endif
+
+        // the baked fonts include the default font
+        ImFontConfig cfg;
+        cfg.SizePixels = ::ImVid::BakedFonts::kSizeDefault;
+        //cfg.OversampleH = 3;
+        ImGui::GetIO().Fonts->AddFontDefault(&cfg);
+    }
 
     ImGui_BeginFrame(window);
     ImGui::NewFrame();
     ImGui::EndFrame();
     ImGui_EndFrame(window);
 
+#ifdef USE_THREADS
+    {
+        const int nThreads = std::min(kMaxWorkerThreads, (int) std::thread::hardware_concurrency() - 1);
+        g_state.workerPool.init(std::max(0, nThreads));
+        printf("Worker threads: %d\n", g_state.workerPool.getNumThreads());
+    }
+#endif
+
+    g_nodeDetails.init(kDetailsMaxBytes);
+
     bool isInitialized = false;
 
     g_doInit = [&]() {
@@ -1559,8 +2969,7 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
         g_state.sizex0 = sizeX*ImGui::GetIO().DisplayFramebufferScale.x;
         g_state.sizey0 = g_state.sizex0*g_state.aspectRatio;
         g_state.onWindowResize();
-        g_state.forceRender = true;
-        g_state.nUpdates = 1;
+        g_state.requestRedraw();
     };
 
     g_setPinch = [&](float x, float y, float scale, int type) {
@@ -1573,28 +2982,33 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
         g_state.pinchPosX1 = x;
         g_state.pinchPosY1 = y;
         g_state.pinchScale = scale;
+
+        g_state.requestRedraw();
     };
 
     g_mainUpdate = [&]() {
-        // framerate throtling when idle
-        --g_state.nUpdates;
-        if (g_state.nUpdates < -30) g_state.nUpdates = 0;
-
         if (isInitialized == false) {
             return true;
         }
 
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
-            g_state.nUpdates = std::max(5, g_state.nUpdates);
+            g_state.requestRedraw(kRedrawFramesPerEvent);
             ImGui_ProcessEvent(&event);
             if (event.type == SDL_QUIT) return false;
             if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_CLOSE && event.window.windowID == SDL_GetWindowID(window)) return false;
+#ifndef __EMSCRIPTEN__
+            if (event.type == SDL_WINDOWEVENT && event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED && event.window.windowID == SDL_GetWindowID(window)) {
+                g_setWindowSize(event.window.data1, event.window.data2);
+            }
+#endif
         }
 
         updatePre();
 
-        if (g_state.nUpdates >= 0) {
+        if (g_state.needsRedraw()) {
+            g_state.nRedrawFrames = std::max(0, g_state.nRedrawFrames - 1);
+
             if (ImGui_BeginFrame(window) == false) {
                 return false;
             }
@@ -1605,12 +3019,27 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
 
         updatePost();
 
+#ifdef __EMSCRIPTEN__
+        // nothing to redraw - stop the main loop until an event or a JS call invalidates the view
+        if (g_state.needsRedraw() == false) {
+            g_state.isMainLoopPaused = true;
+            emscripten_pause_main_loop();
+        }
+#endif
+
         return true;
     };
 
-    g_addNode = [&](const NodeId & id, const std::string & username, int level, int type, int x, int y) {
+    g_addNode = [&](const NodeId & id, const std::string & username, int level, int type, int x, int y, int frames) {
+        auto idx = ::ImVid::TreeIndex::Index(g_state.treeIds.size());
+        if (g_nodes.find(id) != g_nodes.end()) {
+            idx = g_nodes[id].idx;
+        } else {
+            g_state.treeIds.push_back(id);
+        }
+
         g_nodes[id] = {
-            id, id, username, level, type, float(x), float(y),
+            id, id, username, level, type, float(x), float(y), frames, idx,
         };
     };
 
@@ -1640,6 +3069,7 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
         g_state.focusId = id;
         g_state.selectedId = g_state.focusId;
         g_state.doSelect = true;
+        g_state.requestRedraw();
     };
 
     g_getActionOpenUrl = [&]() {
@@ -1650,9 +3080,89 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
 
     g_treeChanged = [&]() {
         g_state.treeChanged = true;
+        g_state.requestRedraw();
+    };
+
+    g_snapshotBegin = [&]() {
+        g_snapshotLoader.begin();
+    };
+
+    g_snapshotFeed = [&](const uint8_t * data, size_t n) {
+        return g_snapshotLoader.feed(data, n);
+    };
+
+    g_snapshotNextSegment = [&]() {
+        return g_snapshotLoader.nextSegment();
+    };
+
+    g_snapshotRestore = [&](const uint8_t * data, size_t n) {
+        return g_snapshotLoader.restore(data, n);
+    };
+
+    g_snapshotSave = [&](std::vector<uint8_t> & data) {
+        return g_snapshotLoader.save(data);
+    };
+
+    g_chunksInit = [&]() {
+        return g_chunkLoader.init();
+    };
+
+    g_chunksAdd = [&](const std::string & name, float xmin, float ymin, float xmax, float ymax, int nNodes) {
+        return g_chunkLoader.add(name, xmin, ymin, xmax, ymax, nNodes);
+    };
+
+    g_chunksUpdate = [&](std::vector<int> & toLoad) {
+        g_chunkLoader.update(toLoad);
+    };
+
+    g_chunksGetName = [&](int index) -> const std::string & {
+        return g_chunkLoader.chunks.get(index).name;
+    };
+
+    g_chunksRequest = [&](int index) {
+        return g_chunkLoader.request(index);
+    };
+
+    g_chunksLoad = [&](int index, const uint8_t * data, size_t n) {
+        return g_chunkLoader.load(index, data, n);
+    };
+
+    g_chunksFailed = [&](int index) {
+        return g_chunkLoader.failed(index);
+    };
+
+    g_detailsGetRequests = [&](std::vector<std::string> & shards) {
+        g_nodeDetails.getRequests(shards);
+    };
+
+    g_detailsLoad = [&](const std::string & name, const uint8_t * data, size_t n) {
+        const bool res = g_nodeDetails.load(name, data, n);
+        g_state.requestRedraw();
+        return res;
+    };
+
+    g_detailsFailed = [&](const std::string & name) {
+        g_nodeDetails.failed(name);
+    };
+
+    g_snapshotFinish = [&]() {
+        if (g_snapshotLoader.finish() == false) {
+            return false;
+        }
+
+        applyData(g_snapshotLoader.data);
+        g_snapshotLoader.data = {};
+
+        return true;
     };
 
 #ifdef __EMSCRIPTEN__
+    // SDL events are pushed from the browser event handlers - use them to wake up the paused main loop
+    SDL_AddEventWatch([](void *, SDL_Event *) {
+        g_state.requestRedraw(kRedrawFramesPerEvent);
+        return 0;
+    }, nullptr);
+
     emscripten_set_main_loop_arg(mainUpdate, NULL, 0, true);
 #else
     loadData();
@@ -1666,12 +3176,9 @@ int main([[maybe_unused]] int argc, [[maybe_unused]] char** argv) {
     while (true) {
         if (g_mainUpdate() == false) break;
 
-        {
-            int sizeX = -1;
-            int sizeY = -1;
-
-            SDL_GetWindowSize(window, &sizeX, &sizeY);
-            g_setWindowSize(sizeX, sizeY);
+        if (g_state.needsRedraw() == false) {
+            // idle - block until the next event arrives (it stays in the queue for g_mainUpdate)
+            SDL_WaitEventTimeout(nullptr, kIdleWaitTimeout_ms);
         }
     }
 
@@ -8,41 +8,102 @@ cd $wd
 
 js="public/js/graph.js"
 data="public/data"
+bin="$wd/build/bin"
+journal="$wd/journal"
+stage="graph"
 
-echo "" > $js
-echo "function graph_create() {" >> $js
+function emit_node {
+    id=$1
 
-for id in `ls $data/nodes` ; do
-    if [ "$id" = "root" ] ; then continue ; fi
     read -r depth < $data/nodes/$id/depth
     depth=$((2*$depth + 0))
+    frames=0
+    if [ -f $data/nodes/$id/frames ] ; then read -r frames < $data/nodes/$id/frames ; fi
 
     if [ "$id" = "1444355917160534024" ] ; then
         # root node
-        echo "nodes.push({ id: '$id', label: \"tweet2doom\", level: $depth, group: \"root\" });" >> $js
+        echo "nodes.push({ id: '$id', label: \"tweet2doom\", level: $depth, group: \"root\", frames: $frames });" >> $js
     else
-        echo "nodes.push({ id: '$id', label: \"tweet2doom\", level: $depth, group: \"node\" });" >> $js
+        echo "nodes.push({ id: '$id', label: \"tweet2doom\", level: $depth, group: \"node\", frames: $frames });" >> $js
     fi
-done
+}
+
+function emit_command {
+    id=$1
 
-for id in `ls $data/processed` ; do
     read -r depth < $data/processed/$id/depth
     depth=$((2*$depth - 1))
     read -r username < $data/processed/$id/username
+    frames=0
+    if [ -f $data/processed/$id/frames_cur ] ; then read -r frames < $data/processed/$id/frames_cur ; fi
 
-    echo "nodes.push({ id: '$id', label: \"$username\", level: $depth, group: \"command\" });" >> $js
-done
+    echo "nodes.push({ id: '$id', label: \"$username\", level: $depth, group: \"command\", frames: $frames });" >> $js
+}
 
-echo "" >> $js
+function emit_edges {
+    id=$1
 
-for id in `ls $data/processed` ; do
     read -r parent_id < $data/processed/$id/parent_id
     read -r child_id < $data/processed/$id/child_id
     echo "edges.push({ from: '$id', to: '$parent_id' });" >> $js
     echo "edges.push({ from: '$child_id', to: '$id' });" >> $js
-done
+}
+
+# only the journal entries since the last run are processed
+last=$($bin/t2d-journal last $journal)
+checkpoint=$($bin/t2d-journal checkpoint $journal $stage)
+pending=$($bin/t2d-journal pending $journal $stage $last)
+
+if [ -f $js ] && [ "$checkpoint" -gt 0 ] && [ -z "$(echo "$pending" | grep ' change ')" ] ; then
+    if [ -z "$pending" ] ; then
+        echo "Graph is up to date"
+        exit 0
+    fi
+
+    echo "Appending $(echo "$pending" | wc -l) entries to the graph"
+
+    # drop the closing brace of graph_create() and append the new nodes and commands
+    sed -i '$ d' $js
+
+    while read -r seq op kind id ; do
+        if [ "$kind" = "node" ] ; then
+            emit_node $id
+        else
+            emit_command $id
+            emit_edges $id
+        fi
+    done <<< "$pending"
+
+    echo "}" >> $js
+else
+    echo "Regenerating the full graph"
 
-echo "}" >> $js
+    echo "" > $js
+    echo "function graph_create() {" >> $js
 
+    for id in `ls $data/nodes` ; do
+        if [ "$id" = "root" ] ; then continue ; fi
+        emit_node $id
+    done
+
+    for id in `ls $data/processed` ; do
+        emit_command $id
+    done
+
+    echo "" >> $js
+
+    for id in `ls $data/processed` ; do
+        emit_edges $id
+    done
+
+    echo "}" >> $js
+fi
+
+# the command details are fetched by the explorer on demand - only the shards of the new commands are rewritten
+$bin/t2d-details update $journal $data $wd/public/json/details || exit 1
+
+# the hierarchical layout is global - rerun it on the updated graph
 cd $wd/layout/vis-network
-node main.js
+node main.js || exit 1
+
+$bin/t2d-journal checkpoint $journal $stage $last
@@ -92,14 +92,98 @@ console.log('generating ...');
 var network = new vis.Network(container, data, options);
 var pos = network.getPositions();
 
-// output json data
+// store the nodes along a Hilbert curve over their positions and the edges in the order of their child node,
+// so that the dense node arrays of the explorer keep nodes that are close on screen close in memory
+// same curve as explorer/core/space-filling-curve.cpp
 {
-    console.log('writing "nodes.json" ...');
-    fs.writeFileSync("../../public/json/nodes.json", JSON.stringify(nodes));
-    console.log('writing "edges.json" ...');
-    fs.writeFileSync("../../public/json/edges.json", JSON.stringify(edges));
-    console.log('writing "positions.json" ...');
-    fs.writeFileSync("../../public/json/positions.json", JSON.stringify(pos));
+    console.log('sorting along a Hilbert curve ..');
+
+    const kBits = 16;
+    const kMaxCell = (1 << kBits) - 1;
+
+    function hilbertKey(x, y) {
+        const n = 1 << kBits;
+
+        var d = 0;
+        for (var s = n/2; s > 0; s = Math.floor(s/2)) {
+            const rx = (x & s) > 0 ? 1 : 0;
+            const ry = (y & s) > 0 ? 1 : 0;
+            d += s*s*((3*rx) ^ ry);
+
+            if (ry == 0) {
+                if (rx == 1) {
+                    x = n - 1 - x;
+                    y = n - 1 - y;
+                }
+                const t = x; x = y; y = t;
+            }
+        }
+
+        return d;
+    }
+
+    var xmin = Infinity, xmax = -Infinity;
+    var ymin = Infinity, ymax = -Infinity;
+    for (var id in pos) {
+        xmin = Math.min(xmin, pos[id].x);
+        xmax = Math.max(xmax, pos[id].x);
+        ymin = Math.min(ymin, pos[id].y);
+        ymax = Math.max(ymax, pos[id].y);
+    }
+
+    const extent = Math.max(xmax - xmin, ymax - ymin);
+    const scale = extent > 0 ? kMaxCell/extent : 0;
+
+    var keys = {};
+    for (var i = 0; i < nodes.length; ++i) {
+        const p = pos[nodes[i].id];
+        if (p === undefined) {
+            keys[nodes[i].id] = 0;
+            continue;
+        }
+
+        const qx = Math.min(kMaxCell, Math.floor((p.x - xmin)*scale));
+        const qy = Math.min(kMaxCell, Math.floor((p.y - ymin)*scale));
+        keys[nodes[i].id] = hilbertKey(qx, qy);
+    }
+
+    // Array.prototype.sort is stable, so ties keep their original order
+    nodes.sort(function(a, b) { return keys[a.id] - keys[b.id]; });
+
+    var rank = {};
+    for (var i = 0; i < nodes.length; ++i) {
+        rank[nodes[i].id] = i;
+    }
+
+    edges.sort(function(a, b) { return (rank[a.from] || 0) - (rank[b.from] || 0); });
+
+    var posSorted = {};
+    for (var i = 0; i < nodes.length; ++i) {
+        if (pos[nodes[i].id] !== undefined) {
+            posSorted[nodes[i].id] = pos[nodes[i].id];
+        }
+    }
+    pos = posSorted;
+
+    console.log('done');
+}
+
+// publish the tree as immutable segments - a base and append-only deltas listed in json/manifest.json
+// together with the spatial chunks and the overview that the explorer loads for very large trees
+// the full json files are no longer written, every update would rewrite them
+{
+    const snapshot = require('./snapshot.js');
+
+    console.log('publishing segments ...');
+    snapshot.publish("../../public/json", nodes, edges, pos);
+    console.log('done');
+
+    // the native explorer loads the whole tree from a single segment
+    const res = snapshot.encode(nodes, edges, pos);
+
+    console.log('writing "snapshot.bin" - ' + res.length + ' bytes ...');
+    fs.writeFileSync("../../data/snapshot.bin", res);
+    console.log('done');
 }
 
 // output nodes
@@ -107,7 +191,7 @@ var pos = network.getPositions();
     var res = '';
     for (var idx in nodes) {
         const node = nodes[idx];
-        res += node.id + ' ' + node.label + ' ' + node.level + ' ' + (node.group == 'root' ? '0' : node.group == 'node' ? '1' : '2') + '\n';
+        res += node.id + ' ' + node.label + ' ' + node.level + ' ' + (node.group == 'root' ? '0' : node.group == 'node' ? '1' : '2') + ' ' + (node.frames || 0) + '\n';
     }
 
     console.log('writing "nodes.dat" ...');
@@ -10,39 +10,23 @@ nfreeze=$((35*10))
 
 dir_doomreplay="$wd/doomreplay"
 dir_tweet2doom="$wd/tweet2doom"
+bin="$wd/build/bin"
 
-cd public/data/nodes
-
-nodes_all="$(ls)"
-nodes=""
-num_nodes=0
-for i in $nodes_all ; do
-    read -r depth < ${i}/depth
-    read -r frames < ${i}/frames
-    if [ $depth -lt 3 ] ; then
-        continue
-    fi
-    if [ $frames -lt $((nrecord + 350)) ] ; then
-        continue
-    fi
-    nodes="$nodes $i"
-    num_nodes=$(($num_nodes + 1))
-done
+journal="$wd/journal"
+data="$wd/public/data"
 
-echo "Total nodes: $num_nodes"
+$bin/t2d-nodes update $journal $data > /dev/null
 
-id_selected=$(echo "$nodes" | tr " " "\n" | sort -R | tail -n 1)
-id_parent=$(cat $id_selected/parent_id)
-id_render=$(cat ../processed/$id_parent/parent_id)
+id_selected=$($bin/t2d-nodes query $journal -d3 -f$((nrecord + 350)) -n1)
+id_parent=$(cat $data/nodes/$id_selected/parent_id)
+id_render=$(cat $data/processed/$id_parent/parent_id)
 
-frames_suggested=$(cat ../processed/$id_parent/frames_cur)
+frames_suggested=$(cat $data/processed/$id_parent/frames_cur)
 
 echo "Selected Id: $id_selected"
 echo "Parent Id:   $id_parent"
 echo "Render Id:   $id_render"
 
-cd ../../../
-
 rm -rf tmp
 mkdir -p tmp
 
@@ -50,55 +34,25 @@ rm -rf .savegame
 ln -sf $dir_doomreplay/.savegame .savegame
 
 for i in $id_render ; do
-    $dir_doomreplay/doomgeneric \
-        -iwad $dir_doomreplay/doom1.wad \
-        -input public/data/nodes/$i/history.txt \
-        -output tmp/$i.mp4 \
-        -nrecord $nrecord \
-        -framerate 35 \
-        -nfreeze $nfreeze \
-        -render_frame \
-        -render_input \
-        -render_username || result=$?
-
-    $dir_tweet2doom/parse-history public/data/nodes/$i/history.txt $nrecord 35 tmp/command_$i 0 1 > /dev/null
+    echo "$i ./render-node.sh $i $nrecord 35 $nfreeze -render_frame -render_input -render_username ; \
+[ -s tmp/$i.mp4 ] && $dir_tweet2doom/parse-history tmp/history_$i.txt $nrecord 35 tmp/command_$i 0 1 > /dev/null" >> tmp/jobs.txt
 done
 
-$dir_tweet2doom/parse-history public/data/nodes/$id_selected/history.txt $frames_suggested 1000 tmp/command_suggested 50 0 > /dev/null
+echo "suggested $bin/t2d-history export public/data/history $id_selected tmp/history_$id_selected.txt && \
+$dir_tweet2doom/parse-history tmp/history_$id_selected.txt $frames_suggested 1000 tmp/command_suggested 50 0 > /dev/null" >> tmp/jobs.txt
+
+$bin/t2d-jobs tmp/jobs.txt -r1 -ltmp/logs
 
-j=0
 cd tmp
+ids=""
 for i in `ls *.mp4 | sort -R` ; do
    echo "file '$i'" >> list
+   ids="$ids ${i%.*}"
 
-   j=$(($j + 1))
-   id=$(echo ${i%.*})
-
-   echo "$id" > id
-
-   for k in `seq 0 $((nseconds - 1))` ; do
-       idx=$(( ($j - 1)*$nseconds + k ))
-
-       ts_m=$(( 1000*($idx    ) ))
-       te_m=$(( 1000*($idx + 1) ))
-
-       ts_s=$(printf "%02d" $(( $ts_m/1000 )) )
-       ts_m=$(printf "%03d" $(( $ts_m - ($ts_m/1000)*1000 )) )
-       te_s=$(printf "%02d" $(( $te_m/1000 )) )
-       te_m=$(printf "%03d" $(( $te_m - ($te_m/1000)*1000 )) )
-
-       cmd=$(cat command_$id | head -n $(($k + 1)) | tail -n 1)
-
-       echo "$(( $idx + 1 ))" >> subs.srt
-       echo "00:00:$ts_s,$ts_m --> 00:00:$te_s,$te_m" >> subs.srt
-       echo "$cmd" >> subs.srt
-       echo "" >> subs.srt
-   done
+   echo "${i%.*}" > id
 done
 
-echo "$(( $idx + 2 ))" >> subs.srt
-echo "00:00:20,500 --> 00:00:30,000" >> subs.srt
-echo "Continue the game from here by replying to the quoted tweet below." >> subs.srt
-echo "Let's play!" >> subs.srt
+$bin/t2d-subs subs.srt . $ids -n$nseconds -l1000 \
+    -a20500 -b30000 -t"Continue the game from here by replying to the quoted tweet below.\nLet's play!"
 
 ffmpeg -f concat -safe 0 -i list -c copy lets-play.mp4
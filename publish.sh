@@ -0,0 +1,31 @@
+#!/bin/bash
+
+wd=$(dirname $0)
+cd $wd/
+wd=$(pwd)
+
+cd $wd/public/
+
+git checkout master
+
+git add data/*
+
+# the explorer loads the tree from immutable segments - a commit only adds the new segment and the manifest
+# graph.js and the full json exports are rewritten on every update and are no longer published
+git rm -q --cached --ignore-unmatch js/graph.js json/nodes.json json/edges.json json/positions.json json/snapshot.bin
+git add json/manifest.json
+git add json/segments/*
+
+# the spatial chunks of large trees - only chunks of changed regions get new files, stale ones are removed
+# smaller trees have no chunks, and their directory is removed together with the chunks published before
+if [ -d json/chunks ] || [ -n "$(git ls-files json/chunks)" ]; then
+    git add -A json/chunks
+fi
+
+# the command details shards, fetched by the explorer on demand
+git add -A json/details
+
+git commit -m "New states added [`date`]"
+
+git pull --rebase || exit 1
+git push
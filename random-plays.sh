@@ -11,30 +11,13 @@ nfreeze=$(($nseconds))
 
 dir_doomreplay="$wd/doomreplay"
 dir_tweet2doom="$wd/tweet2doom"
+bin="$wd/build/bin"
 
-cd public/data/nodes
+journal="$wd/journal"
 
-nodes_all="$(ls)"
-nodes=""
-num_nodes=0
-for i in $nodes_all ; do
-    read -r depth < ${i}/depth
-    read -r frames < ${i}/frames
-    if [ $depth -lt 3 ] ; then
-        continue
-    fi
-    if [ $frames -lt $((nrecord + 1)) ] ; then
-        continue
-    fi
-    nodes="$nodes $i"
-    num_nodes=$(($num_nodes + 1))
-done
-
-echo "Total nodes: $num_nodes"
-
-nodes_render=$(echo "$nodes" | tr " " "\n" | sort -R | tail -n $nplays)
+$bin/t2d-nodes update $journal public/data > /dev/null
 
-cd ../../../
+nodes_render=$($bin/t2d-nodes query $journal -d3 -f$((nrecord + 1)) -n$nplays)
 
 rm -rf tmp
 mkdir -p tmp
@@ -42,47 +25,22 @@ mkdir -p tmp
 rm -rf .savegame
 ln -sf $dir_doomreplay/.savegame .savegame
 
+# one job per clip, rendered in parallel - a clip is done when its video exists and its commands are parsed
 for i in $nodes_render ; do
-    $dir_doomreplay/doomgeneric \
-        -iwad $dir_doomreplay/doom1.wad \
-        -input public/data/nodes/$i/history.txt \
-        -output tmp/$i.mp4 \
-        -nrecord $nrecord \
-        -framerate 60 \
-        -nfreeze $nfreeze \
-        -render_frame \
-        -render_input \
-        -render_username || result=$?
-
-    $dir_tweet2doom/parse-history public/data/nodes/$i/history.txt $nrecord 35 tmp/command_$i 0 1 > /dev/null
+    echo "$i ./render-node.sh $i $nrecord 60 $nfreeze -render_frame -render_input -render_username ; \
+[ -s tmp/$i.mp4 ] && $dir_tweet2doom/parse-history tmp/history_$i.txt $nrecord 35 tmp/command_$i 0 1 > /dev/null" >> tmp/jobs.txt
 done
 
-j=0
+$bin/t2d-jobs tmp/jobs.txt -r1 -ltmp/logs
+
 cd tmp
+ids=""
 for i in `ls *.mp4 | sort -R` ; do
    echo "file '$i'" >> list
-
-   j=$(($j + 1))
-   id=$(echo ${i%.*})
-
-   for k in `seq 0 $((nseconds - 1))` ; do
-       idx=$(( ($j - 1)*$nseconds + k ))
-
-       ts_m=$(( 600*($idx    ) ))
-       te_m=$(( 600*($idx + 1) ))
-
-       ts_s=$(printf "%02d" $(( $ts_m/1000 )) )
-       ts_m=$(printf "%03d" $(( $ts_m - ($ts_m/1000)*1000 )) )
-       te_s=$(printf "%02d" $(( $te_m/1000 )) )
-       te_m=$(printf "%03d" $(( $te_m - ($te_m/1000)*1000 )) )
-
-       cmd=$(cat command_$id | head -n $(($k + 1)) | tail -n 1)
-
-       echo "$(( $idx + 1 ))" >> subs.srt
-       echo "00:00:$ts_s,$ts_m --> 00:00:$te_s,$te_m" >> subs.srt
-       echo "$cmd" >> subs.srt
-       echo "" >> subs.srt
-   done
+   ids="$ids ${i%.*}"
 done
 
+# 0.6 s per command
+$bin/t2d-subs subs.srt . $ids -n$nseconds -l600
+
 ffmpeg -f concat -safe 0 -i list -c copy highlights.mp4
@@ -10,6 +10,7 @@ cd $wd
 wd=$(pwd)
 
 dir_doomreplay="$wd/doomreplay"
+bin="$wd/build/bin"
 
 rm -rf tmp
 mkdir -p tmp
@@ -17,13 +18,8 @@ mkdir -p tmp
 rm -rf .savegame
 ln -sf $dir_doomreplay/.savegame .savegame
 
-$dir_doomreplay/doomgeneric \
-    -iwad $dir_doomreplay/doom1.wad \
-    -input public/data/nodes/$1/history.txt \
-    -output tmp/$1.mp4 \
-    -nrecord 99999 \
-    -framerate $2 \
-    -nfreeze $3 \
+# the full chain is recorded, so the replay always starts from the first tic
+./render-node.sh $1 99999 $2 $3 \
     -render_frame \
     -render_input \
     -render_username || result=$?
@@ -0,0 +1,93 @@
+#!/bin/bash
+
+# Renders the history of a node to tmp/<id>.mp4 (and exports it to tmp/history_<id>.txt)
+#
+# With T2D_CHECKPOINTS=1 the replay starts from the savestate of the deepest cached ancestor that is at least
+# nrecord frames before the node, and a new savestate is written for the deepest uncached ancestor at every
+# depth_stride-th depth. This needs a doomreplay with -loadstate, -savestate and -savestate_frame.
+#
+# Renders can run in parallel - the changes to the checkpoint cache are serialized with a lock, and the savestates
+# are written to files of the job.
+#
+# Set DOOMGENERIC to use a different executable, e.g. the stub of check-checkpoints.sh.
+
+if [ $# -lt 4 ] ; then
+    echo "Usage: $0 id nrecord framerate nfreeze [doomgeneric args]"
+    exit 1
+fi
+
+wd=$(dirname $0)
+cd $wd
+wd=$(pwd)
+
+id=$1
+nrecord=$2
+framerate=$3
+nfreeze=$4
+shift 4
+
+dir_doomreplay="$wd/doomreplay"
+doomgeneric=${DOOMGENERIC:-$dir_doomreplay/doomgeneric}
+bin="$wd/build/bin"
+data="$wd/public/data"
+cache="$wd/cache/checkpoints"
+lock="$wd/cache/checkpoints.lock"
+
+depth_stride=10
+cache_size_mb=2048
+
+mkdir -p tmp
+
+$bin/t2d-history export $data/history $id tmp/history_$id.txt || exit 1
+
+input=tmp/history_$id.txt
+args=""
+save_id=""
+
+if [ "${T2D_CHECKPOINTS:-0}" = "1" ] ; then
+    mkdir -p $wd/cache
+
+    # the base savestate is linked to a file of the job, so that an eviction by another job cannot remove it
+    base=$(
+        {
+            flock 9
+            base=$($bin/t2d-checkpoints find $cache $data $id $nrecord tmp/suffix_$id.txt)
+            base=${base:-0}
+            if [ "$base" != "0" ] ; then
+                ln -f $cache/$base/state tmp/base_$id 2> /dev/null || cp $cache/$base/state tmp/base_$id || base=0
+            fi
+            echo $base
+        } 9> $lock
+    )
+
+    if [ "$base" != "0" ] ; then
+        echo "Resuming node $id from the checkpoint of node $base"
+        input=tmp/suffix_$id.txt
+        args="-loadstate tmp/base_$id"
+    fi
+
+    read -r save_id save_frame <<< "$(flock -s $lock $bin/t2d-checkpoints plan $cache $data $id $base -e$depth_stride)"
+    if [ -n "$save_id" ] ; then
+        state=tmp/state_${id}_$save_id
+        rm -f $state
+        args="$args -savestate $state -savestate_frame $save_frame"
+    fi
+fi
+
+$doomgeneric \
+    -iwad $dir_doomreplay/doom1.wad \
+    -input $input \
+    -output tmp/$id.mp4 \
+    -nrecord $nrecord \
+    -framerate $framerate \
+    -nfreeze $nfreeze \
+    $args "$@"
+result=$?
+
+if [ -n "$save_id" ] && [ -f $state ] ; then
+    flock $lock $bin/t2d-checkpoints add $cache $data $save_id $state -s$cache_size_mb
+fi
+
+rm -f tmp/base_$id
+
+exit $result
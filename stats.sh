@@ -4,14 +4,59 @@ wd=$(dirname $0)
 cd $wd
 wd=$(pwd)
 
-cd $wd/public/data/processed
+bin="$wd/build/bin"
+journal="$wd/journal"
+stage="stats"
+state="$journal/stats"
 
-max_depth=$(for i in `find -name *depth` ; do cat $i ; done | sort -n | tail -n 1)
-num_players=$(for i in `find -name *username` ; do cat $i ; echo ""; done | sort | uniq | wc -l)
+mkdir -p $state
 
-cd $wd/public/data/nodes
-max_frames=$(for i in `find -name *frames` ; do cat $i ; done | sort -n | tail -n 1)
-num_nodes=$(($(ls -l | wc -l) - 1))
+last=$($bin/t2d-journal last $journal)
+checkpoint=$($bin/t2d-journal checkpoint $journal $stage)
+
+if [ "$checkpoint" -eq 0 ] || [ ! -f $state/players ] ; then
+    # first run - scan everything
+    cd $wd/public/data/processed
+
+    max_depth=$(for i in `find -name *depth` ; do cat $i ; done | sort -n | tail -n 1)
+    for i in `find -name *username` ; do cat $i ; echo ""; done | sort | uniq > $state/players
+
+    cd $wd/public/data/nodes
+    max_frames=$(for i in `find -name *frames` ; do cat $i ; done | sort -n | tail -n 1)
+    num_nodes=$(($(ls -l | wc -l) - 1))
+else
+    # update the saved stats with the journal entries since the last run
+    read -r max_depth  < $state/max_depth
+    read -r max_frames < $state/max_frames
+    read -r num_nodes  < $state/num_nodes
+
+    cd $wd/public/data
+
+    while read -r seq op kind id ; do
+        if [ -z "$id" ] ; then continue ; fi
+
+        if [ "$kind" = "command" ] ; then
+            read -r depth < processed/$id/depth
+            if [ $depth -gt $max_depth ] ; then max_depth=$depth ; fi
+            cat processed/$id/username >> $state/players
+            echo "" >> $state/players
+        else
+            read -r frames < nodes/$id/frames
+            if [ $frames -gt $max_frames ] ; then max_frames=$frames ; fi
+            if [ "$op" = "add" ] ; then num_nodes=$(($num_nodes + 1)) ; fi
+        fi
+    done <<< "$($bin/t2d-journal pending $journal $stage $last)"
+
+    sort -u -o $state/players $state/players
+fi
+
+num_players=$(cat $state/players | wc -l)
+
+echo "$max_depth"  > $state/max_depth
+echo "$max_frames" > $state/max_frames
+echo "$num_nodes"  > $state/num_nodes
+
+$bin/t2d-journal checkpoint $journal $stage $last
 
 echo "Max depth:   $max_depth"
 echo "Max frames:  $max_frames"
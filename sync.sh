@@ -2,8 +2,11 @@
 
 src="../tweet2doom"
 dst="./public"
+bin="./build/bin"
+journal="./journal"
 
-rsync -rtvum \
+# the itemized rsync output is turned into journal entries for the downstream stages
+rsync -rtvum --out-format='%i %n' \
     --include='*parent_id' \
     --include='*child_id' \
     --include='*depth' \
@@ -11,11 +14,19 @@ rsync -rtvum \
     --include='*input-cur.txt' \
     --include='*frames_cur' \
     --include='*cmd.txt' \
-    --include='*/' --exclude='*' $src/processed/ $dst/data/processed/
+    --include='*/' --exclude='*' $src/processed/ $dst/data/processed/ > log-rsync-processed.txt
 
-rsync -rtvum \
+rsync -rtvum --out-format='%i %n' \
     --include='*depth' \
     --include='*frames' \
     --include='*parent_id' \
-    --include='*history.txt' \
-    --include='*/' --exclude='*' $src/nodes/ $dst/data/nodes/
+    --include='*/' --exclude='*' $src/nodes/ $dst/data/nodes/ > log-rsync-nodes.txt
+
+cat log-rsync-processed.txt log-rsync-nodes.txt
+
+# the full histories are not copied - only their deltas are added to the history store
+# use "t2d-history export" to get the history.txt of a node
+$bin/t2d-history import $src $dst/data/history
+
+$bin/t2d-journal append $journal processed < log-rsync-processed.txt
+$bin/t2d-journal append $journal nodes < log-rsync-nodes.txt
@@ -16,7 +16,8 @@ bool ImGui_PreInit() {
 #elif __EMSCRIPTEN__
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS, 0);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
-#ifdef USE_LINE_SHADER
+// the line and the id shaders need WebGL 2
+#if defined(USE_LINE_SHADER) || defined(USE_GPU_PICKING)
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
 #else
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
@@ -44,7 +45,7 @@ ImGuiContext* ImGui_Init(SDL_Window* window, SDL_GLContext gl_context) {
     // GL 3.2 Core + GLSL 150
     const char* glsl_version = "#version 150";
 #elif __EMSCRIPTEN__
-#ifdef USE_LINE_SHADER
+#if defined(USE_LINE_SHADER) || defined(USE_GPU_PICKING)
     const char* glsl_version = "#version 300 es";
 #else
     const char* glsl_version = "#version 100";
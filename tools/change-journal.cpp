@@ -0,0 +1,225 @@
+#include "change-journal.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    void readEntries(std::ifstream & fin, int64_t afterSeq, std::vector<T2D::ChangeJournal::Entry> & res) {
+        std::string line;
+        T2D::ChangeJournal::Entry entry;
+        while (std::getline(fin, line)) {
+            if (T2D::ChangeJournal::parse(line, entry) == false) {
+                fprintf(stderr, "Skipping invalid journal entry '%s'\n", line.c_str());
+                continue;
+            }
+            if (entry.seq > afterSeq) res.push_back(entry);
+        }
+    }
+}
+
+namespace T2D {
+
+ChangeJournal::ChangeJournal() {}
+
+ChangeJournal::~ChangeJournal() {}
+
+bool ChangeJournal::open(const std::string & path) {
+    m_path = path;
+    m_lastSeq = 0;
+
+    if (makePath(m_path) == false) return false;
+
+    // the last entry has the largest sequence number
+    std::ifstream fin(getJournalPath());
+    if (fin.good() == false) return true;
+
+    fin.seekg(0, std::ios::end);
+    const int64_t size = fin.tellg();
+    fin.seekg(std::max<int64_t>(0, size - 4096));
+
+    std::string line;
+    Entry entry;
+    while (std::getline(fin, line)) {
+        if (parse(line, entry)) m_lastSeq = entry.seq;
+    }
+
+    return true;
+}
+
+bool ChangeJournal::append(std::vector<Entry> & entries) {
+    if (entries.empty()) return true;
+
+    std::ofstream fout(getJournalPath(), std::ios::app);
+    if (fout.good() == false) {
+        fprintf(stderr, "Failed to open journal '%s'\n", getJournalPath().c_str());
+        return false;
+    }
+
+    for (auto & entry : entries) {
+        entry.seq = ++m_lastSeq;
+        fout << entry.seq << " " << toString(entry.op) << " " << toString(entry.kind) << " " << entry.id << "\n";
+    }
+
+    fout.flush();
+    if (fout.good() == false) {
+        fprintf(stderr, "Failed to write journal '%s'\n", getJournalPath().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool ChangeJournal::read(int64_t afterSeq, std::vector<Entry> & res) const {
+    std::ifstream fin(getJournalPath(), std::ios::binary);
+    if (fin.good() == false) return true;
+
+    readEntries(fin, afterSeq, res);
+
+    return true;
+}
+
+bool ChangeJournal::readPending(const std::string & stage, std::vector<Entry> & res) const {
+    std::ifstream fin(getJournalPath(), std::ios::binary);
+    if (fin.good() == false) return true;
+
+    auto checkpoint = loadCheckpoint(stage);
+    seekAfter(fin, checkpoint);
+
+    readEntries(fin, checkpoint.seq, res);
+
+    return true;
+}
+
+int64_t ChangeJournal::getCheckpoint(const std::string & stage) const {
+    return loadCheckpoint(stage).seq;
+}
+
+bool ChangeJournal::setCheckpoint(const std::string & stage, int64_t seq) {
+    if (seq > m_lastSeq) {
+        fprintf(stderr, "Checkpoint %" PRId64 " of stage '%s' is past the end of the journal (%" PRId64 ")\n", seq, stage.c_str(), m_lastSeq);
+        return false;
+    }
+
+    auto checkpoint = loadCheckpoint(stage);
+    if (seq < checkpoint.seq) {
+        checkpoint = {};
+    }
+
+    // the entries up to seq are read only from the current checkpoint on
+    if (seq > checkpoint.seq) {
+        std::ifstream fin(getJournalPath(), std::ios::binary);
+        if (fin.good()) {
+            seekAfter(fin, checkpoint);
+        }
+
+        int64_t offset = 0;
+        std::string line;
+        Entry entry;
+        while (fin.good() && std::getline(fin, line) && fin.eof() == false) {
+            if (parse(line, entry) && entry.seq == seq) {
+                offset = fin.tellg();
+                break;
+            }
+        }
+
+        // the next read scans the journal from the start
+        checkpoint.offset = offset;
+    }
+
+    return writeFile(getCheckpointPath(stage), std::to_string(seq) + " " + std::to_string(checkpoint.offset) + "\n");
+}
+
+const char * ChangeJournal::toString(Op op) {
+    switch (op) {
+        case Op::Add:    return "add";
+        case Op::Change: return "change";
+    };
+
+    return "";
+}
+
+const char * ChangeJournal::toString(Kind kind) {
+    switch (kind) {
+        case Kind::Node:    return "node";
+        case Kind::Command: return "command";
+    };
+
+    return "";
+}
+
+bool ChangeJournal::parse(const std::string & line, Entry & res) {
+    std::istringstream ss(line);
+    std::string op;
+    std::string kind;
+    ss >> res.seq >> op >> kind >> res.id;
+    if (ss.fail()) return false;
+
+    if (op == "add") {
+        res.op = Op::Add;
+    } else if (op == "change") {
+        res.op = Op::Change;
+    } else {
+        return false;
+    }
+
+    if (kind == "node") {
+        res.kind = Kind::Node;
+    } else if (kind == "command") {
+        res.kind = Kind::Command;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+std::string ChangeJournal::getJournalPath() const {
+    return m_path + "/journal.txt";
+}
+
+std::string ChangeJournal::getCheckpointPath(const std::string & stage) const {
+    return m_path + "/" + stage + ".checkpoint";
+}
+
+ChangeJournal::Checkpoint ChangeJournal::loadCheckpoint(const std::string & stage) const {
+    Checkpoint res;
+
+    std::string line;
+    if (readLine(getCheckpointPath(stage), line) == false) return res;
+
+    // checkpoints without an offset are read from the start of the journal
+    std::istringstream ss(line);
+    if ((ss >> res.seq).fail() || res.seq < 0) return {};
+    if ((ss >> res.offset).fail() || res.offset < 0) res.offset = 0;
+
+    return res;
+}
+
+void ChangeJournal::seekAfter(std::ifstream & fin, Checkpoint & checkpoint) const {
+    fin.seekg(0, std::ios::end);
+    const int64_t size = fin.tellg();
+
+    // the offset is right after the line of the checkpoint and the next line is the entry after it
+    bool isValid = checkpoint.offset > 0 && checkpoint.offset <= size;
+    if (isValid) {
+        fin.seekg(checkpoint.offset - 1);
+        isValid = fin.get() == '\n';
+    }
+    if (isValid && checkpoint.offset < size) {
+        std::string line;
+        Entry entry;
+        isValid = std::getline(fin, line) && parse(line, entry) && entry.seq == checkpoint.seq + 1;
+    }
+
+    if (isValid == false) {
+        checkpoint.offset = 0;
+    }
+
+    fin.clear();
+    fin.seekg(checkpoint.offset);
+}
+
+}
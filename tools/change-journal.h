@@ -0,0 +1,86 @@
+#pragma once
+
+#include "common.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace T2D {
+
+// Append-only journal of the nodes and commands added or changed by sync.sh
+//
+// Every entry gets a sequence number that increases monotonically over the lifetime of the journal.
+// Each downstream stage keeps a checkpoint - the last sequence number it has processed - and on the next
+// run consumes only the entries after it. The checkpoint also keeps the byte offset of the journal right after
+// that entry, so the pending entries are read without scanning the journal from the start.
+//
+//   <path>/journal.txt         - one "<seq> <add|change> <node|command> <id>" line per entry
+//   <path>/<stage>.checkpoint  - "<seq> <offset>", last processed sequence number of a stage and the offset after it
+//
+class ChangeJournal {
+public:
+    enum class Op {
+        Add,
+        Change,
+    };
+
+    enum class Kind {
+        Node,
+        Command,
+    };
+
+    struct Entry {
+        int64_t seq = 0;
+        Op op = Op::Add;
+        Kind kind = Kind::Node;
+        NodeId id = 0;
+    };
+
+    ChangeJournal();
+    ~ChangeJournal();
+
+    bool open(const std::string & path);
+
+    int64_t getLastSeq() const { return m_lastSeq; }
+
+    // assigns sequence numbers to the entries and appends them
+    bool append(std::vector<Entry> & entries);
+
+    // entries with seq > afterSeq - scans the whole journal
+    bool read(int64_t afterSeq, std::vector<Entry> & res) const;
+
+    // entries after the checkpoint of the stage - reads from the offset of the checkpoint on
+    bool readPending(const std::string & stage, std::vector<Entry> & res) const;
+
+    // 0 if the stage has never run
+    int64_t getCheckpoint(const std::string & stage) const;
+
+    // finds the offset after the entry by reading from the current checkpoint of the stage on
+    bool setCheckpoint(const std::string & stage, int64_t seq);
+
+    static const char * toString(Op op);
+    static const char * toString(Kind kind);
+    static bool parse(const std::string & line, Entry & res);
+
+private:
+    struct Checkpoint {
+        int64_t seq = 0;
+        int64_t offset = 0;
+    };
+
+    std::string getJournalPath() const;
+    std::string getCheckpointPath(const std::string & stage) const;
+
+    Checkpoint loadCheckpoint(const std::string & stage) const;
+
+    // positions the stream at the first entry after the checkpoint - at the start of the journal if the offset
+    // does not point there, e.g. for checkpoints written before the offsets were kept
+    void seekAfter(std::ifstream & fin, Checkpoint & checkpoint) const;
+
+    std::string m_path;
+    int64_t m_lastSeq = 0;
+};
+
+}
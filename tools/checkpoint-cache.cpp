@@ -0,0 +1,156 @@
+#include "checkpoint-cache.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+
+bool getFileInfo(const std::string & fname, int64_t & size_bytes, int64_t & mtime) {
+    struct stat st;
+    if (stat(fname.c_str(), &st) != 0) return false;
+
+    size_bytes = st.st_size;
+    mtime = st.st_mtime;
+
+    return true;
+}
+
+}
+
+namespace T2D {
+
+CheckpointCache::CheckpointCache() {}
+
+CheckpointCache::~CheckpointCache() {}
+
+bool CheckpointCache::open(const std::string & path, int64_t maxSize_bytes) {
+    m_path = path;
+    m_maxSize_bytes = maxSize_bytes;
+    m_size_bytes = 0;
+    m_checkpoints.clear();
+
+    if (makePath(m_path) == false) return false;
+
+    std::vector<std::string> names;
+    if (listDir(m_path, names) == false) return false;
+
+    for (const auto & name : names) {
+        NodeId id = 0;
+        if (parseNodeId(name, id) == false) continue;
+
+        Checkpoint checkpoint;
+        if (readInt(getCheckpointPath(id) + "/frames", checkpoint.frames) == false ||
+            getFileInfo(getStatePath(id), checkpoint.size_bytes, checkpoint.lastUsed) == false) {
+            // interrupted add
+            fprintf(stderr, "Removing incomplete checkpoint %" PRId64 "\n", id);
+            unlink(getStatePath(id).c_str());
+            unlink((getCheckpointPath(id) + "/frames").c_str());
+            rmdir(getCheckpointPath(id).c_str());
+            continue;
+        }
+
+        m_checkpoints[id] = checkpoint;
+        m_size_bytes += checkpoint.size_bytes;
+    }
+
+    return true;
+}
+
+bool CheckpointCache::contains(NodeId id) const {
+    return m_checkpoints.find(id) != m_checkpoints.end();
+}
+
+int64_t CheckpointCache::getFrames(NodeId id) const {
+    const auto it = m_checkpoints.find(id);
+    if (it == m_checkpoints.end()) return 0;
+
+    return it->second.frames;
+}
+
+std::string CheckpointCache::getStatePath(NodeId id) const {
+    return getCheckpointPath(id) + "/state";
+}
+
+void CheckpointCache::touch(NodeId id) {
+    const auto it = m_checkpoints.find(id);
+    if (it == m_checkpoints.end()) return;
+
+    utimensat(AT_FDCWD, getStatePath(id).c_str(), nullptr, 0);
+    it->second.lastUsed = time(nullptr);
+}
+
+bool CheckpointCache::add(NodeId id, int64_t frames, const std::string & fnameState) {
+    Checkpoint checkpoint;
+    checkpoint.frames = frames;
+    if (getFileInfo(fnameState, checkpoint.size_bytes, checkpoint.lastUsed) == false) {
+        fprintf(stderr, "Savestate '%s' does not exist\n", fnameState.c_str());
+        return false;
+    }
+
+    if (checkpoint.size_bytes > m_maxSize_bytes) {
+        fprintf(stderr, "Savestate '%s' is larger than the cache\n", fnameState.c_str());
+        return false;
+    }
+
+    if (contains(id)) remove(id);
+
+    evict(checkpoint.size_bytes);
+
+    if (makePath(getCheckpointPath(id)) == false) return false;
+
+    // the state is moved first - a checkpoint without frames is removed on the next open
+    if (rename(fnameState.c_str(), getStatePath(id).c_str()) != 0) {
+        std::string data;
+        if (readFile(fnameState, data) == false || writeFile(getStatePath(id), data) == false) {
+            fprintf(stderr, "Failed to move '%s' into the cache\n", fnameState.c_str());
+            return false;
+        }
+        unlink(fnameState.c_str());
+    }
+
+    if (writeFile(getCheckpointPath(id) + "/frames", std::to_string(frames) + "\n") == false) return false;
+
+    checkpoint.lastUsed = time(nullptr);
+    utimensat(AT_FDCWD, getStatePath(id).c_str(), nullptr, 0);
+
+    m_checkpoints[id] = checkpoint;
+    m_size_bytes += checkpoint.size_bytes;
+
+    return true;
+}
+
+std::string CheckpointCache::getCheckpointPath(NodeId id) const {
+    return m_path + "/" + std::to_string(id);
+}
+
+bool CheckpointCache::remove(NodeId id) {
+    const auto it = m_checkpoints.find(id);
+    if (it == m_checkpoints.end()) return false;
+
+    m_size_bytes -= it->second.size_bytes;
+    m_checkpoints.erase(it);
+
+    unlink(getStatePath(id).c_str());
+    unlink((getCheckpointPath(id) + "/frames").c_str());
+
+    return rmdir(getCheckpointPath(id).c_str()) == 0;
+}
+
+void CheckpointCache::evict(int64_t size_bytes) {
+    while (m_checkpoints.empty() == false && m_size_bytes + size_bytes > m_maxSize_bytes) {
+        auto lru = m_checkpoints.begin();
+        for (auto it = m_checkpoints.begin(); it != m_checkpoints.end(); ++it) {
+            if (it->second.lastUsed < lru->second.lastUsed) lru = it;
+        }
+
+        printf("Evicting checkpoint %" PRId64 "\n", lru->first);
+        remove(lru->first);
+    }
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "common.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace T2D {
+
+// Disk cache of doomreplay savestates, so that a render can resume from an ancestor of the node
+//
+//   <path>/<id>/state   - savestate of the game at the end of the history of the node
+//   <path>/<id>/frames  - number of frames in the history of the node
+//
+// The total size is bounded - when a new checkpoint does not fit, the least recently used ones (by the
+// modification time of their state file) are removed.
+//
+class CheckpointCache {
+public:
+    static constexpr int64_t kDefaultSize_bytes = 2ll*1024*1024*1024;
+
+    CheckpointCache();
+    ~CheckpointCache();
+
+    bool open(const std::string & path, int64_t maxSize_bytes = kDefaultSize_bytes);
+
+    bool contains(NodeId id) const;
+    int64_t getFrames(NodeId id) const;
+    std::string getStatePath(NodeId id) const;
+
+    // marks the checkpoint as recently used
+    void touch(NodeId id);
+
+    // moves the savestate file into the cache
+    bool add(NodeId id, int64_t frames, const std::string & fnameState);
+
+    int getNumCheckpoints() const { return (int) m_checkpoints.size(); }
+    int64_t getSize_bytes() const { return m_size_bytes; }
+
+private:
+    struct Checkpoint {
+        int64_t frames = 0;
+        int64_t size_bytes = 0;
+        int64_t lastUsed = 0;
+    };
+
+    std::string getCheckpointPath(NodeId id) const;
+
+    bool remove(NodeId id);
+
+    // removes the least recently used checkpoints until size_bytes more fit
+    void evict(int64_t size_bytes);
+
+    std::string m_path;
+    int64_t m_maxSize_bytes = 0;
+    int64_t m_size_bytes = 0;
+
+    std::unordered_map<NodeId, Checkpoint> m_checkpoints;
+};
+
+}
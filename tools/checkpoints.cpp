@@ -0,0 +1,164 @@
+// Savestate checkpoints of the nodes, so that a render replays only the end of the history of a node
+//
+// Usage:
+//
+//   t2d-checkpoints find path/to/cache path/to/data id min_frames suffix.txt
+//      prints the deepest ancestor of the node with a checkpoint at least min_frames before the node and
+//      writes the part of the node history after the ancestor to suffix.txt - prints 0 if there is none
+//
+//   t2d-checkpoints plan path/to/cache path/to/data id base [-eDEPTH_STRIDE]
+//      prints "<ancestor> <frame>" - the deepest node on the path from base to id (inclusive) with a non-zero depth
+//      divisible by DEPTH_STRIDE (default: 10) and no checkpoint yet, and the frame of the replay from base
+//      at which its savestate should be written - prints nothing if there is none
+//
+//   t2d-checkpoints add path/to/cache path/to/data id state [-sMAX_SIZE_MB]
+//      moves the savestate of the node into the cache, evicting the least recently used checkpoints
+//
+//   t2d-checkpoints stats path/to/cache
+//
+
+#include "common.h"
+#include "checkpoint-cache.h"
+#include "history-store.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kMaxDepth = 1 << 20;
+
+int printUsage(const char * argv0) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s find path/to/cache path/to/data id min_frames suffix.txt\n", argv0);
+    fprintf(stderr, "  %s plan path/to/cache path/to/data id base [-eDEPTH_STRIDE]\n", argv0);
+    fprintf(stderr, "  %s add path/to/cache path/to/data id state [-sMAX_SIZE_MB]\n", argv0);
+    fprintf(stderr, "  %s stats path/to/cache\n", argv0);
+    return -1;
+}
+
+int64_t getNodeInt(const std::string & pathData, T2D::NodeId id, const char * name) {
+    int64_t res = 0;
+    T2D::readInt(pathData + "/nodes/" + std::to_string(id) + "/" + name, res);
+
+    return res;
+}
+
+int doFind(T2D::CheckpointCache & cache, const std::string & pathData, T2D::NodeId id, int64_t minFrames, const std::string & fnameSuffix) {
+    const auto frames = getNodeInt(pathData, id, "frames");
+
+    T2D::NodeId idBase = 0;
+    T2D::NodeId cur = T2D::getBaseNode(pathData, id);
+    for (int n = 0; cur != 0 && n < kMaxDepth; ++n) {
+        if (cache.contains(cur) && frames - cache.getFrames(cur) >= minFrames) {
+            idBase = cur;
+            break;
+        }
+        cur = T2D::getBaseNode(pathData, cur);
+    }
+
+    if (idBase == 0) {
+        printf("0\n");
+        return 0;
+    }
+
+    T2D::HistoryStore store;
+    if (store.open(pathData + "/history") == false) return -2;
+
+    std::string history;
+    std::string historyBase;
+    if (store.get(id, history) == false || store.get(idBase, historyBase) == false) return -3;
+
+    // should not happen - the history of a node always extends the history of its base
+    if (historyBase.size() > history.size() || history.compare(0, historyBase.size(), historyBase) != 0) {
+        fprintf(stderr, "History of node %" PRId64 " does not extend the history of %" PRId64 "\n", id, idBase);
+        printf("0\n");
+        return 0;
+    }
+
+    if (T2D::writeFile(fnameSuffix, history.substr(historyBase.size())) == false) return -4;
+
+    cache.touch(idBase);
+
+    printf("%" PRId64 "\n", idBase);
+
+    return 0;
+}
+
+int doPlan(const T2D::CheckpointCache & cache, const std::string & pathData, T2D::NodeId id, T2D::NodeId idBase, int64_t depthStride) {
+    if (depthStride <= 0) {
+        fprintf(stderr, "Invalid depth stride %" PRId64 "\n", depthStride);
+        return -2;
+    }
+
+    const auto framesBase = idBase == 0 ? 0 : cache.getFrames(idBase);
+
+    T2D::NodeId cur = id;
+    for (int n = 0; cur != 0 && cur != idBase && n < kMaxDepth; ++n) {
+        const auto depth = getNodeInt(pathData, cur, "depth");
+        if (depth > 0 && depth % depthStride == 0 && cache.contains(cur) == false) {
+            printf("%" PRId64 " %" PRId64 "\n", cur, getNodeInt(pathData, cur, "frames") - framesBase);
+            break;
+        }
+        cur = T2D::getBaseNode(pathData, cur);
+    }
+
+    return 0;
+}
+
+}
+
+int main(int argc, char ** argv) {
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] == '-') {
+            if (argv[i][1] == 0) return printUsage(argv[0]);
+            continue;
+        }
+        positional.push_back(argv[i]);
+    }
+
+    if (positional.size() < 2) return printUsage(argv[0]);
+
+    const auto args = T2D::parseCmdArguments(argc, argv);
+
+    const auto getArg = [&](const char * name, int64_t def) {
+        const auto it = args.find(name);
+        return (it == args.end() || it->second.empty()) ? def : (int64_t) std::stoll(it->second);
+    };
+
+    const std::string cmd = positional[0];
+
+    T2D::CheckpointCache cache;
+    if (cache.open(positional[1], getArg("s", T2D::CheckpointCache::kDefaultSize_bytes >> 20) << 20) == false) return -1;
+
+    T2D::NodeId id = 0;
+    if (positional.size() > 3 && T2D::parseNodeId(positional[3], id) == false) {
+        fprintf(stderr, "Invalid node id '%s'\n", positional[3].c_str());
+        return -1;
+    }
+
+    if (cmd == "find" && positional.size() == 6) {
+        return doFind(cache, positional[2], id, std::stoll(positional[4]), positional[5]);
+    }
+
+    if (cmd == "plan" && positional.size() == 5) {
+        return doPlan(cache, positional[2], id, std::stoll(positional[4]), getArg("e", 10));
+    }
+
+    if (cmd == "add" && positional.size() == 5) {
+        const auto frames = getNodeInt(positional[2], id, "frames");
+        return cache.add(id, frames, positional[4]) ? 0 : -2;
+    }
+
+    if (cmd == "stats" && positional.size() == 2) {
+        printf("Checkpoints: %d\n", cache.getNumCheckpoints());
+        printf("Size:        %.1f MB\n", cache.getSize_bytes()/1024.0/1024.0);
+        return 0;
+    }
+
+    return printUsage(argv[0]);
+}
@@ -0,0 +1,153 @@
+#include "common.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace T2D {
+
+std::map<std::string, std::string> parseCmdArguments(int argc, char ** argv) {
+    std::map<std::string, std::string> res;
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] == '-') {
+            if (strlen(argv[i]) > 1) {
+                res[std::string(1, argv[i][1])] = strlen(argv[i]) > 2 ? argv[i] + 2 : "";
+            }
+        }
+    }
+
+    return res;
+}
+
+bool fileExists(const std::string & path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+bool isDirectory(const std::string & path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool makePath(const std::string & path) {
+    if (path.empty() || isDirectory(path)) return true;
+
+    const auto slash = path.rfind('/', path.size() - 2);
+    if (slash != std::string::npos && slash > 0) {
+        if (makePath(path.substr(0, slash)) == false) return false;
+    }
+
+    if (mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Failed to create folder '%s'\n", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool readFile(const std::string & fname, std::string & res) {
+    std::ifstream fin(fname, std::ios::binary);
+    if (fin.good() == false) return false;
+
+    std::ostringstream ss;
+    ss << fin.rdbuf();
+    res = ss.str();
+
+    return true;
+}
+
+bool writeFile(const std::string & fname, const std::string & data) {
+    // per process, so that concurrent writers of the same file do not write into each other's temporary file
+    const auto fnameTmp = fname + ".tmp" + std::to_string(getpid());
+
+    {
+        std::ofstream fout(fnameTmp, std::ios::binary);
+        if (fout.good() == false) {
+            fprintf(stderr, "Failed to open '%s' for writing\n", fnameTmp.c_str());
+            return false;
+        }
+
+        fout.write(data.data(), data.size());
+        if (fout.good() == false) {
+            fprintf(stderr, "Failed to write '%s'\n", fnameTmp.c_str());
+            return false;
+        }
+    }
+
+    if (rename(fnameTmp.c_str(), fname.c_str()) != 0) {
+        fprintf(stderr, "Failed to rename '%s'\n", fnameTmp.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool readLine(const std::string & fname, std::string & res) {
+    std::ifstream fin(fname);
+    if (fin.good() == false) return false;
+
+    std::getline(fin, res);
+    while (res.empty() == false && std::isspace((unsigned char) res.back())) res.pop_back();
+
+    return true;
+}
+
+bool readInt(const std::string & fname, int64_t & res) {
+    std::string line;
+    if (readLine(fname, line) == false || line.empty()) return false;
+
+    char * end = nullptr;
+    res = std::strtoll(line.c_str(), &end, 10);
+
+    return end != line.c_str();
+}
+
+bool listDir(const std::string & path, std::vector<std::string> & res) {
+    DIR * dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        fprintf(stderr, "Failed to open folder '%s'\n", path.c_str());
+        return false;
+    }
+
+    while (auto entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name == "." || name == "..") continue;
+        res.push_back(name);
+    }
+
+    closedir(dir);
+
+    return true;
+}
+
+bool parseNodeId(const std::string & s, NodeId & res) {
+    if (s.empty() || s.size() > 19) return false;
+
+    res = 0;
+    for (const auto c : s) {
+        if (c < '0' || c > '9') return false;
+        res = 10*res + (c - '0');
+    }
+
+    return true;
+}
+
+NodeId getBaseNode(const std::string & pathData, NodeId id) {
+    int64_t idCommand = 0;
+    if (readInt(pathData + "/nodes/" + std::to_string(id) + "/parent_id", idCommand) == false) return 0;
+
+    int64_t idBase = 0;
+    if (readInt(pathData + "/processed/" + std::to_string(idCommand) + "/parent_id", idBase) == false) return 0;
+
+    return idBase;
+}
+
+}
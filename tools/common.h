@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// helpers shared by the data pipeline tools
+//
+// the data folder has the layout produced by sync.sh:
+//
+//   nodes/<id>/depth, frames, parent_id, history.txt
+//   processed/<id>/depth, username, parent_id, child_id, frames_cur, input-cur.txt, cmd.txt
+//
+
+namespace T2D {
+
+using NodeId = int64_t;
+
+template <class T>
+float getTime_ms(const T & tStart, const T & tEnd) {
+    return ((float)(std::chrono::duration_cast<std::chrono::microseconds>(tEnd - tStart).count()))/1000.0;
+}
+
+// "-xVALUE" -> res["x"] = "VALUE"
+std::map<std::string, std::string> parseCmdArguments(int argc, char ** argv);
+
+bool fileExists(const std::string & path);
+bool isDirectory(const std::string & path);
+
+// mkdir -p
+bool makePath(const std::string & path);
+
+bool readFile(const std::string & fname, std::string & res);
+
+// writes to a temporary file first, so that readers never see a partially written file
+// concurrent writers of the same file are safe - the last one wins
+bool writeFile(const std::string & fname, const std::string & data);
+
+// first line of a small text file, without trailing whitespace
+bool readLine(const std::string & fname, std::string & res);
+bool readInt(const std::string & fname, int64_t & res);
+
+// names of the entries in a folder, without "." and ".."
+bool listDir(const std::string & path, std::vector<std::string> & res);
+
+// node and command folders are named after the tweet id
+bool parseNodeId(const std::string & s, NodeId & res);
+
+// node -> command that created it -> node on which the command was executed, 0 for the root node
+NodeId getBaseNode(const std::string & pathData, NodeId id);
+
+}
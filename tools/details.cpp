@@ -0,0 +1,153 @@
+// Detail files of the commands, fetched by the explorer on demand
+//
+// Usage:
+//
+//   t2d-details update path/to/journal path/to/data path/to/details
+//      rewrites the shards of the commands from the journal entries since the last update (all shards on the
+//      first run)
+//
+// The commands are grouped into shards by the first kPrefixLength digits of their id. Snowflake ids grow with
+// time, so a shard holds the commands of a time window and a node and its recent ancestors are often in the
+// same shard. The format of <prefix>.txt is described in explorer/core/node-details.h:
+//
+//   T2DD 1
+//   <id> <length of cmd.txt> <length of input-cur.txt>
+//   <cmd.txt><input-cur.txt>
+//   ...
+//
+
+#include "common.h"
+#include "change-journal.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char * kStage = "details";
+
+// must match explorer/core/node-details.h
+const size_t kPrefixLength = 6;
+
+int printUsage(const char * argv0) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s update path/to/journal path/to/data path/to/details\n", argv0);
+    return -1;
+}
+
+std::string getPrefix(const std::string & id) {
+    return id.substr(0, kPrefixLength);
+}
+
+// the trailing newline that most of the files end with is not part of the text
+std::string readText(const std::string & fname) {
+    std::string res;
+    if (T2D::readFile(fname, res) == false) return "";
+
+    while (res.empty() == false && (res.back() == '\n' || res.back() == '\r')) res.pop_back();
+
+    return res;
+}
+
+bool writeShard(const std::string & dataPath, const std::string & outPath, const std::string & prefix, const std::vector<std::string> & ids) {
+    std::string data = "T2DD 1\n";
+
+    int n = 0;
+    for (const auto & id : ids) {
+        const auto path = dataPath + "/processed/" + id;
+        if (T2D::isDirectory(path) == false) continue;
+
+        const auto cmd = readText(path + "/cmd.txt");
+        const auto input = readText(path + "/input-cur.txt");
+
+        data += id + " " + std::to_string(cmd.size()) + " " + std::to_string(input.size()) + "\n";
+        data += cmd;
+        data += input;
+        data += "\n";
+
+        ++n;
+    }
+
+    const auto fname = outPath + "/" + prefix + ".txt";
+    if (n == 0) {
+        remove(fname.c_str());
+        return true;
+    }
+
+    return T2D::writeFile(fname, data);
+}
+
+int doUpdate(const std::string & journalPath, const std::string & dataPath, const std::string & outPath) {
+    T2D::ChangeJournal journal;
+    if (journal.open(journalPath) == false) return -2;
+    if (T2D::makePath(outPath) == false) return -2;
+
+    const auto tStart = std::chrono::high_resolution_clock::now();
+
+    const auto last = journal.getLastSeq();
+    const auto checkpoint = journal.getCheckpoint(kStage);
+
+    // all commands, grouped by prefix - the folder names are sorted, so are the ids of a shard
+    std::vector<std::string> names;
+    if (T2D::listDir(dataPath + "/processed", names) == false) return -3;
+
+    std::set<std::string> ids;
+    for (const auto & name : names) {
+        T2D::NodeId id = 0;
+        if (T2D::parseNodeId(name, id) == false) continue;
+        ids.insert(name);
+    }
+
+    std::set<std::string> prefixes;
+    if (checkpoint == 0) {
+        printf("Writing the details of all %d commands\n", (int) ids.size());
+        for (const auto & id : ids) {
+            prefixes.insert(getPrefix(id));
+        }
+    } else {
+        std::vector<T2D::ChangeJournal::Entry> entries;
+        if (journal.readPending(kStage, entries) == false) return -3;
+
+        for (const auto & entry : entries) {
+            if (entry.seq > last) break;
+            if (entry.kind != T2D::ChangeJournal::Kind::Command) continue;
+            prefixes.insert(getPrefix(std::to_string(entry.id)));
+        }
+    }
+
+    int nShards = 0;
+    for (const auto & prefix : prefixes) {
+        std::vector<std::string> shard;
+        for (auto it = ids.lower_bound(prefix); it != ids.end() && it->compare(0, prefix.size(), prefix) == 0; ++it) {
+            shard.push_back(*it);
+        }
+
+        if (writeShard(dataPath, outPath, prefix, shard) == false) return -4;
+        ++nShards;
+    }
+
+    if (journal.setCheckpoint(kStage, last) == false) return -5;
+
+    const auto tEnd = std::chrono::high_resolution_clock::now();
+
+    printf("Details: %d shards written in %.3f ms\n", nShards, T2D::getTime_ms(tStart, tEnd));
+
+    return 0;
+}
+
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 2) return printUsage(argv[0]);
+
+    const std::string cmd = argv[1];
+
+    if (cmd == "update" && argc == 5) {
+        return doUpdate(argv[2], argv[3], argv[4]);
+    }
+
+    return printUsage(argv[0]);
+}
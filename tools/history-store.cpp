@@ -0,0 +1,288 @@
+#include "history-store.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace {
+    // guards against cycles in corrupted stores - far deeper than any real game
+    const int kMaxChainLength = 1 << 20;
+
+    std::string hashContents(const std::string & data) {
+        // FNV-1a
+        uint64_t h = 0xcbf29ce484222325ull;
+        for (const auto c : data) {
+            h ^= (uint8_t) c;
+            h *= 0x100000001b3ull;
+        }
+
+        char buf[17];
+        snprintf(buf, sizeof(buf), "%016" PRIx64, h);
+
+        return buf;
+    }
+}
+
+namespace T2D {
+
+HistoryStore::HistoryStore() {}
+
+HistoryStore::~HistoryStore() {}
+
+bool HistoryStore::open(const std::string & path, size_t cacheSize_bytes) {
+    m_path = path;
+    m_refs.clear();
+    m_cache.clear();
+    m_cacheIndex.clear();
+    m_cacheSize_bytes = cacheSize_bytes;
+    m_cacheUsed_bytes = 0;
+
+    if (makePath(m_path + "/objects") == false) return false;
+    if (makePath(m_path + "/nodes") == false) return false;
+    if (makePath(m_path + "/snapshots") == false) return false;
+
+    return true;
+}
+
+bool HistoryStore::contains(NodeId id) {
+    if (m_refs.find(id) != m_refs.end()) return true;
+
+    return fileExists(getNodePath(id));
+}
+
+bool HistoryStore::add(NodeId id, NodeId baseId, const std::string & history, bool & isDelta) {
+    NodeId base = 0;
+    int64_t depth = 0;
+    std::string delta;
+
+    if (baseId != 0 && contains(baseId)) {
+        std::string historyBase;
+        int64_t depthBase = 0;
+        if (materialize(baseId, historyBase, depthBase) &&
+            historyBase.size() <= history.size() &&
+            history.compare(0, historyBase.size(), historyBase) == 0) {
+            base = baseId;
+            depth = depthBase + 1;
+            delta = history.substr(historyBase.size());
+        }
+    }
+
+    isDelta = base != 0;
+    if (isDelta == false) {
+        delta = history;
+    }
+
+    Ref ref;
+    ref.baseId = base;
+    if (writeObject(delta, ref.hash) == false) return false;
+
+    if (writeFile(getNodePath(id), std::to_string(ref.baseId) + " " + ref.hash + "\n") == false) return false;
+
+    m_refs[id] = ref;
+    cacheInsert(id, depth, history);
+
+    if (depth > 0 && depth % kSnapshotStride == 0) {
+        writeSnapshot(id, depth, history);
+    }
+
+    return true;
+}
+
+bool HistoryStore::get(NodeId id, std::string & history) {
+    int64_t depth = 0;
+
+    return materialize(id, history, depth);
+}
+
+bool HistoryStore::materialize(NodeId id, std::string & history, int64_t & depth) {
+    struct Link {
+        NodeId id;
+        Ref ref;
+    };
+
+    // walk up until a cached history, a snapshot or the start of the chain
+    std::vector<Link> chain;
+    std::string res;
+
+    // depth of the history in res - the start of the chain is at depth 0
+    int64_t depthRes = -1;
+
+    NodeId cur = id;
+    while (true) {
+        if (const auto cached = cacheGet(cur)) {
+            res = cached->history;
+            depthRes = cached->depth;
+            break;
+        }
+
+        if (readSnapshot(cur, res, depthRes)) {
+            cacheInsert(cur, depthRes, res);
+            break;
+        }
+
+        Link link;
+        link.id = cur;
+        if (loadRef(cur, link.ref) == false) {
+            fprintf(stderr, "History of node %" PRId64 " is not in the store\n", cur);
+            return false;
+        }
+        chain.push_back(link);
+
+        if (link.ref.baseId == 0) break;
+
+        if ((int) chain.size() > kMaxChainLength) {
+            fprintf(stderr, "History chain of node %" PRId64 " is too long - cycle?\n", id);
+            return false;
+        }
+
+        cur = link.ref.baseId;
+    }
+
+    // apply the deltas from the oldest node down, caching every kCacheStride-th history on the way and writing
+    // the snapshots that are missing
+    std::string delta;
+    for (int i = (int) chain.size() - 1; i >= 0; --i) {
+        if (readFile(getObjectPath(chain[i].ref.hash), delta) == false) {
+            fprintf(stderr, "Missing history object '%s'\n", chain[i].ref.hash.c_str());
+            return false;
+        }
+        res += delta;
+        ++depthRes;
+
+        if (i == 0 || (chain.size() - i) % kCacheStride == 0) {
+            cacheInsert(chain[i].id, depthRes, res);
+        }
+
+        if (depthRes > 0 && depthRes % kSnapshotStride == 0) {
+            writeSnapshot(chain[i].id, depthRes, res);
+        }
+    }
+
+    history = std::move(res);
+    depth = depthRes;
+
+    return true;
+}
+
+std::string HistoryStore::getObjectPath(const std::string & hash) const {
+    return m_path + "/objects/" + hash.substr(0, 2) + "/" + hash.substr(2);
+}
+
+std::string HistoryStore::getNodePath(NodeId id) const {
+    return m_path + "/nodes/" + std::to_string(id);
+}
+
+std::string HistoryStore::getSnapshotPath(NodeId id) const {
+    return m_path + "/snapshots/" + std::to_string(id);
+}
+
+bool HistoryStore::loadRef(NodeId id, Ref & ref) {
+    {
+        const auto it = m_refs.find(id);
+        if (it != m_refs.end()) {
+            ref = it->second;
+            return true;
+        }
+    }
+
+    std::string line;
+    if (readLine(getNodePath(id), line) == false) return false;
+
+    std::istringstream ss(line);
+    ss >> ref.baseId >> ref.hash;
+    if (ss.fail() || ref.hash.size() < 3) {
+        fprintf(stderr, "Invalid history entry for node %" PRId64 ": '%s'\n", id, line.c_str());
+        return false;
+    }
+
+    m_refs[id] = ref;
+
+    return true;
+}
+
+bool HistoryStore::writeObject(const std::string & data, std::string & hash) {
+    hash = hashContents(data);
+
+    const auto path = getObjectPath(hash);
+    if (fileExists(path)) {
+        std::string existing;
+        if (readFile(path, existing) && existing == data) return true;
+
+        fprintf(stderr, "Hash collision for history object '%s'\n", hash.c_str());
+        return false;
+    }
+
+    if (makePath(m_path + "/objects/" + hash.substr(0, 2)) == false) return false;
+    if (writeFile(path, data) == false) return false;
+
+    m_nObjectsAdded++;
+    m_bytesAdded += data.size();
+
+    return true;
+}
+
+bool HistoryStore::readSnapshot(NodeId id, std::string & history, int64_t & depth) const {
+    std::string data;
+    if (readFile(getSnapshotPath(id), data) == false) return false;
+
+    const auto eol = data.find('\n');
+    if (eol == std::string::npos) {
+        fprintf(stderr, "Invalid history snapshot of node %" PRId64 "\n", id);
+        return false;
+    }
+
+    char * end = nullptr;
+    depth = strtoll(data.c_str(), &end, 10);
+    if (end != data.c_str() + eol || depth <= 0) {
+        fprintf(stderr, "Invalid history snapshot of node %" PRId64 "\n", id);
+        return false;
+    }
+
+    history = data.substr(eol + 1);
+
+    return true;
+}
+
+void HistoryStore::writeSnapshot(NodeId id, int64_t depth, const std::string & history) const {
+    // only a shortcut - the history can always be reconstructed from the deltas
+    if (fileExists(getSnapshotPath(id))) return;
+    if (writeFile(getSnapshotPath(id), std::to_string(depth) + "\n" + history) == false) {
+        fprintf(stderr, "Failed to write the history snapshot of node %" PRId64 "\n", id);
+    }
+}
+
+const HistoryStore::CacheEntry * HistoryStore::cacheGet(NodeId id) {
+    const auto it = m_cacheIndex.find(id);
+    if (it == m_cacheIndex.end()) return nullptr;
+
+    m_cache.splice(m_cache.begin(), m_cache, it->second);
+
+    return &*it->second;
+}
+
+void HistoryStore::cacheInsert(NodeId id, int64_t depth, const std::string & history) {
+    if (history.size() > m_cacheSize_bytes) return;
+
+    {
+        const auto it = m_cacheIndex.find(id);
+        if (it != m_cacheIndex.end()) {
+            m_cacheUsed_bytes -= it->second->history.size();
+            m_cache.erase(it->second);
+            m_cacheIndex.erase(it);
+        }
+    }
+
+    while (m_cache.empty() == false && m_cacheUsed_bytes + history.size() > m_cacheSize_bytes) {
+        m_cacheUsed_bytes -= m_cache.back().history.size();
+        m_cacheIndex.erase(m_cache.back().id);
+        m_cache.pop_back();
+    }
+
+    m_cache.push_front({ id, depth, history });
+    m_cacheIndex[id] = m_cache.begin();
+    m_cacheUsed_bytes += history.size();
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "common.h"
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace T2D {
+
+// Prefix-shared store of the node input histories
+//
+// The history of a node is the history of its base node (the node before the last command) plus a short
+// delta. Only the deltas are stored, content-addressed so that equal deltas are kept once:
+//
+//   <path>/objects/<hh>/<hash>  - delta contents
+//   <path>/nodes/<id>           - "<base id> <hash>", base id 0 means that the delta is the full history
+//   <path>/snapshots/<id>       - "<chain depth>\n<full history>" of every kSnapshotStride-th node along a chain
+//
+// Full histories are reconstructed by walking the base chain up to the nearest snapshot, so each export reads
+// at most kSnapshotStride deltas, also in a fresh process. The snapshots are written when the nodes are added
+// and when a chain without them is walked. Within a process, recently materialized histories (including every
+// kCacheStride-th node along each reconstructed chain) are also kept in an LRU cache.
+//
+class HistoryStore {
+public:
+    static constexpr size_t kDefaultCacheSize_bytes = 64*1024*1024;
+    static constexpr int kCacheStride = 16;
+    static constexpr int kSnapshotStride = 32;
+
+    HistoryStore();
+    ~HistoryStore();
+
+    bool open(const std::string & path, size_t cacheSize_bytes = kDefaultCacheSize_bytes);
+
+    bool contains(NodeId id);
+
+    // stores the delta of history relative to the history of baseId
+    // if baseId is not in the store or its history is not a prefix, the full history is stored - isDelta tells which
+    bool add(NodeId id, NodeId baseId, const std::string & history, bool & isDelta);
+
+    // reconstructs the full history of a node
+    bool get(NodeId id, std::string & history);
+
+    int getNumObjectsAdded() const { return m_nObjectsAdded; }
+    size_t getBytesAdded() const { return m_bytesAdded; }
+
+private:
+    struct Ref {
+        NodeId baseId = 0;
+        std::string hash;
+    };
+
+    struct CacheEntry {
+        NodeId id = 0;
+        int64_t depth = 0;
+        std::string history;
+    };
+
+    std::string getObjectPath(const std::string & hash) const;
+    std::string getNodePath(NodeId id) const;
+    std::string getSnapshotPath(NodeId id) const;
+
+    // depth is the number of deltas on top of the full history at the start of the chain
+    bool materialize(NodeId id, std::string & history, int64_t & depth);
+
+    bool loadRef(NodeId id, Ref & ref);
+    bool writeObject(const std::string & data, std::string & hash);
+
+    bool readSnapshot(NodeId id, std::string & history, int64_t & depth) const;
+    void writeSnapshot(NodeId id, int64_t depth, const std::string & history) const;
+
+    const CacheEntry * cacheGet(NodeId id);
+    void cacheInsert(NodeId id, int64_t depth, const std::string & history);
+
+    std::string m_path;
+
+    std::unordered_map<NodeId, Ref> m_refs;
+
+    int m_nObjectsAdded = 0;
+    size_t m_bytesAdded = 0;
+
+    // LRU of materialized histories, most recently used at the front
+    size_t m_cacheSize_bytes = 0;
+    size_t m_cacheUsed_bytes = 0;
+    std::list<CacheEntry> m_cache;
+    std::unordered_map<NodeId, std::list<CacheEntry>::iterator> m_cacheIndex;
+};
+
+}
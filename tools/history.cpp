@@ -0,0 +1,117 @@
+// Maintains the prefix-shared history store and exports full history.txt files for doomgeneric
+//
+// Usage:
+//
+//   t2d-history import path/to/data path/to/store
+//      adds the nodes in data/nodes/<id>/history.txt that are not in the store yet
+//
+//   t2d-history export path/to/store id [output]
+//      writes the full history of a node to output (stdout by default)
+//
+
+#include "common.h"
+#include "history-store.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+int printUsage(const char * argv0) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s import path/to/data path/to/store\n", argv0);
+    fprintf(stderr, "  %s export path/to/store id [output]\n", argv0);
+    return -1;
+}
+
+int doImport(const std::string & pathData, const std::string & pathStore) {
+    const auto tStart = std::chrono::high_resolution_clock::now();
+
+    T2D::HistoryStore store;
+    if (store.open(pathStore) == false) return -2;
+
+    std::vector<std::string> names;
+    if (T2D::listDir(pathData + "/nodes", names) == false) return -3;
+
+    // add the new nodes in order of depth, so that the base of each node is already in the store
+    std::vector<std::pair<int64_t, T2D::NodeId>> todo;
+    for (const auto & name : names) {
+        T2D::NodeId id = 0;
+        if (T2D::parseNodeId(name, id) == false) continue;
+        if (store.contains(id)) continue;
+
+        int64_t depth = 0;
+        T2D::readInt(pathData + "/nodes/" + name + "/depth", depth);
+
+        todo.push_back({ depth, id });
+    }
+    std::sort(todo.begin(), todo.end());
+
+    int nAdded = 0;
+    int nFull = 0;
+    std::string history;
+    for (const auto & [depth, id] : todo) {
+        if (T2D::readFile(pathData + "/nodes/" + std::to_string(id) + "/history.txt", history) == false) continue;
+
+        bool isDelta = false;
+        const auto idBase = T2D::getBaseNode(pathData, id);
+        if (store.add(id, idBase, history, isDelta) == false) {
+            fprintf(stderr, "Failed to add history of node %" PRId64 "\n", id);
+            return -4;
+        }
+
+        if (isDelta == false) ++nFull;
+        ++nAdded;
+    }
+
+    const auto tEnd = std::chrono::high_resolution_clock::now();
+
+    printf("Added %d nodes (%d full histories), %d new objects, %d bytes in %.1f ms\n",
+           nAdded, nFull, store.getNumObjectsAdded(), (int) store.getBytesAdded(), T2D::getTime_ms(tStart, tEnd));
+
+    return 0;
+}
+
+int doExport(const std::string & pathStore, const std::string & idStr, const char * fnameOut) {
+    T2D::NodeId id = 0;
+    if (T2D::parseNodeId(idStr, id) == false) {
+        fprintf(stderr, "Invalid node id '%s'\n", idStr.c_str());
+        return -2;
+    }
+
+    T2D::HistoryStore store;
+    if (store.open(pathStore) == false) return -3;
+
+    std::string history;
+    if (store.get(id, history) == false) return -4;
+
+    if (fnameOut == nullptr) {
+        fwrite(history.data(), 1, history.size(), stdout);
+        return 0;
+    }
+
+    if (T2D::writeFile(fnameOut, history) == false) return -5;
+
+    return 0;
+}
+
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 2) return printUsage(argv[0]);
+
+    const std::string cmd = argv[1];
+
+    if (cmd == "import" && argc == 4) {
+        return doImport(argv[2], argv[3]);
+    }
+
+    if (cmd == "export" && (argc == 4 || argc == 5)) {
+        return doExport(argv[2], argv[3], argc == 5 ? argv[4] : nullptr);
+    }
+
+    return printUsage(argv[0]);
+}
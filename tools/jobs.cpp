@@ -0,0 +1,194 @@
+// Runs independent shell jobs concurrently with a bounded number of workers
+//
+// Usage:
+//
+//   t2d-jobs path/to/jobs.txt [-jWORKERS] [-rRETRIES] [-lLOG_DIR]
+//
+//   jobs.txt has one "<name> <command>" per line - the command is run with /bin/sh -c
+//
+//   -j  max number of jobs running at the same time (default: number of cores)
+//   -r  number of times a failed job is restarted (default: 0)
+//   -l  folder for the output of the jobs, one <name>.log per job (default: logs)
+//
+// Returns 0 if all jobs succeeded, otherwise prints the failed jobs and returns 1 - the number of failures does not
+// fit in an exit code.
+//
+
+#include "common.h"
+
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int printUsage(const char * argv0) {
+    fprintf(stderr, "Usage: %s path/to/jobs.txt [-jWORKERS] [-rRETRIES] [-lLOG_DIR]\n", argv0);
+    return -1;
+}
+
+struct Job {
+    std::string name;
+    std::string cmd;
+
+    int nAttempts = 0;
+    int status = 0;
+
+    std::chrono::high_resolution_clock::time_point tStart;
+};
+
+bool loadJobs(const std::string & fname, std::vector<Job> & res) {
+    std::ifstream fin(fname);
+    if (fin.good() == false) {
+        fprintf(stderr, "Failed to open '%s'\n", fname.c_str());
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(fin, line)) {
+        const auto pos = line.find(' ');
+        if (line.empty() || line[0] == '#') continue;
+        if (pos == std::string::npos) {
+            fprintf(stderr, "Job '%s' has no command\n", line.c_str());
+            return false;
+        }
+
+        Job job;
+        job.name = line.substr(0, pos);
+        job.cmd = line.substr(pos + 1);
+        res.push_back(job);
+    }
+
+    return true;
+}
+
+// the output of every attempt is appended to the log of the job
+pid_t startJob(Job & job, const std::string & logDir) {
+    const auto fnameLog = logDir + "/" + job.name + ".log";
+
+    const pid_t pid = fork();
+    if (pid < 0) {
+        fprintf(stderr, "fork failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    if (pid == 0) {
+        const int fd = open(fnameLog.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd >= 0) {
+            dprintf(fd, "==== %s (attempt %d): %s\n", job.name.c_str(), job.nAttempts + 1, job.cmd.c_str());
+            dup2(fd, STDOUT_FILENO);
+            dup2(fd, STDERR_FILENO);
+            close(fd);
+        }
+
+        execl("/bin/sh", "sh", "-c", job.cmd.c_str(), (char *) nullptr);
+        _exit(127);
+    }
+
+    ++job.nAttempts;
+    job.tStart = std::chrono::high_resolution_clock::now();
+
+    return pid;
+}
+
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 2 || argv[1][0] == '-') return printUsage(argv[0]);
+
+    for (int i = 2; i < argc; ++i) {
+        if (argv[i][0] != '-' || argv[i][1] == 0) return printUsage(argv[0]);
+    }
+
+    const auto args = T2D::parseCmdArguments(argc, argv);
+
+    const auto getArg = [&](const char * name, int def) {
+        const auto it = args.find(name);
+        return (it == args.end() || it->second.empty()) ? def : std::stoi(it->second);
+    };
+
+    const int nWorkers = std::max(1, getArg("j", std::max(1, (int) std::thread::hardware_concurrency())));
+    const int nRetries = std::max(0, getArg("r", 0));
+    const std::string logDir = args.count("l") && args.at("l").empty() == false ? args.at("l") : "logs";
+
+    std::vector<Job> jobs;
+    if (loadJobs(argv[1], jobs) == false) return -1;
+
+    if (T2D::makePath(logDir) == false) return -2;
+
+    for (const auto & job : jobs) {
+        unlink((logDir + "/" + job.name + ".log").c_str());
+    }
+
+    printf("Running %d jobs with %d workers\n", (int) jobs.size(), nWorkers);
+    fflush(stdout);
+
+    const auto tStart = std::chrono::high_resolution_clock::now();
+
+    // queue of job indices - retries go to the back
+    std::vector<int> queue;
+    for (int i = 0; i < (int) jobs.size(); ++i) queue.push_back(i);
+
+    std::map<pid_t, int> running;
+    std::vector<int> failed;
+
+    size_t next = 0;
+    while (next < queue.size() || running.empty() == false) {
+        while (next < queue.size() && (int) running.size() < nWorkers) {
+            auto & job = jobs[queue[next++]];
+
+            const pid_t pid = startJob(job, logDir);
+            if (pid < 0) return -3;
+
+            running[pid] = queue[next - 1];
+        }
+
+        int status = 0;
+        const pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "waitpid failed: %s\n", strerror(errno));
+            return -4;
+        }
+
+        const auto it = running.find(pid);
+        if (it == running.end()) continue;
+
+        const int idx = it->second;
+        running.erase(it);
+
+        auto & job = jobs[idx];
+        job.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+
+        const auto tEnd = std::chrono::high_resolution_clock::now();
+        const float t_s = 0.001f*T2D::getTime_ms(job.tStart, tEnd);
+
+        if (job.status == 0) {
+            printf("[done]  %s in %.1f s\n", job.name.c_str(), t_s);
+        } else if (job.nAttempts <= nRetries) {
+            printf("[retry] %s failed with code %d after %.1f s\n", job.name.c_str(), job.status, t_s);
+            queue.push_back(idx);
+        } else {
+            printf("[fail]  %s failed with code %d after %.1f s - see %s/%s.log\n", job.name.c_str(), job.status, t_s, logDir.c_str(), job.name.c_str());
+            failed.push_back(idx);
+        }
+        fflush(stdout);
+    }
+
+    const auto tEnd = std::chrono::high_resolution_clock::now();
+
+    printf("Finished %d jobs in %.1f s, %d failed\n", (int) jobs.size(), 0.001f*T2D::getTime_ms(tStart, tEnd), (int) failed.size());
+
+    return failed.empty() ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+// Change journal written by sync.sh and consumed by the downstream pipeline stages
+//
+// Usage:
+//
+//   t2d-journal append path/to/journal nodes|processed < rsync.log
+//      parses rsync output produced with --out-format='%i %n' and appends one entry per new or changed id
+//
+//   t2d-journal last path/to/journal
+//      prints the sequence number of the last entry
+//
+//   t2d-journal pending path/to/journal stage [upto]
+//      prints the entries after the checkpoint of the stage (up to and including seq upto)
+//
+//   t2d-journal checkpoint path/to/journal stage [seq]
+//      marks all entries up to seq as processed by the stage, or prints the current checkpoint
+//
+
+#include "common.h"
+#include "change-journal.h"
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace {
+
+int printUsage(const char * argv0) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s append path/to/journal nodes|processed < rsync.log\n", argv0);
+    fprintf(stderr, "  %s last path/to/journal\n", argv0);
+    fprintf(stderr, "  %s pending path/to/journal stage [upto]\n", argv0);
+    fprintf(stderr, "  %s checkpoint path/to/journal stage [seq]\n", argv0);
+    return -1;
+}
+
+int doAppend(T2D::ChangeJournal & journal, const std::string & source) {
+    using Journal = T2D::ChangeJournal;
+
+    Journal::Kind kind;
+    if (source == "nodes") {
+        kind = Journal::Kind::Node;
+    } else if (source == "processed") {
+        kind = Journal::Kind::Command;
+    } else {
+        fprintf(stderr, "Unknown source '%s'\n", source.c_str());
+        return -2;
+    }
+
+    // "<itemize> <id>/<file>" - a new folder means a new id, anything else inside it is a change
+    std::map<T2D::NodeId, Journal::Op> ops;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        const auto space = line.find(' ');
+        if (space == std::string::npos || space < 2) continue;
+
+        const auto itemize = line.substr(0, space);
+        const auto name = line.substr(space + 1);
+
+        // only transfers and created items, not deletions or messages
+        if (itemize[0] != '>' && itemize[0] != 'c') continue;
+
+        T2D::NodeId id = 0;
+        if (T2D::parseNodeId(name.substr(0, name.find('/')), id) == false) continue;
+
+        const bool isNew = itemize[1] == 'd' && itemize.find("+++") != std::string::npos;
+        if (isNew) {
+            ops[id] = Journal::Op::Add;
+        } else if (ops.find(id) == ops.end()) {
+            ops[id] = Journal::Op::Change;
+        }
+    }
+
+    std::vector<Journal::Entry> entries;
+    for (const auto & [id, op] : ops) {
+        Journal::Entry entry;
+        entry.op = op;
+        entry.kind = kind;
+        entry.id = id;
+        entries.push_back(entry);
+    }
+
+    if (journal.append(entries) == false) return -3;
+
+    printf("Journal: %d new entries, last seq %" PRId64 "\n", (int) entries.size(), journal.getLastSeq());
+
+    return 0;
+}
+
+// non-negative decimal sequence number
+bool parseSeq(const char * s, int64_t & res) {
+    char * end = nullptr;
+    errno = 0;
+    res = strtoll(s, &end, 10);
+
+    return end != s && *end == '\0' && errno == 0 && res >= 0;
+}
+
+int doPending(const T2D::ChangeJournal & journal, const std::string & stage, int64_t upto) {
+    std::vector<T2D::ChangeJournal::Entry> entries;
+    if (journal.readPending(stage, entries) == false) return -2;
+
+    for (const auto & entry : entries) {
+        if (entry.seq > upto) break;
+        printf("%" PRId64 " %s %s %" PRId64 "\n", entry.seq,
+               T2D::ChangeJournal::toString(entry.op), T2D::ChangeJournal::toString(entry.kind), entry.id);
+    }
+
+    return 0;
+}
+
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 3) return printUsage(argv[0]);
+
+    const std::string cmd = argv[1];
+
+    T2D::ChangeJournal journal;
+    if (journal.open(argv[2]) == false) return -1;
+
+    if (cmd == "append" && argc == 4) {
+        return doAppend(journal, argv[3]);
+    }
+
+    if (cmd == "last" && argc == 3) {
+        printf("%" PRId64 "\n", journal.getLastSeq());
+        return 0;
+    }
+
+    if (cmd == "pending" && (argc == 4 || argc == 5)) {
+        int64_t upto = journal.getLastSeq();
+        if (argc == 5 && parseSeq(argv[4], upto) == false) {
+            fprintf(stderr, "Invalid sequence number '%s'\n", argv[4]);
+            return printUsage(argv[0]);
+        }
+
+        return doPending(journal, argv[3], upto);
+    }
+
+    if (cmd == "checkpoint" && argc == 4) {
+        printf("%" PRId64 "\n", journal.getCheckpoint(argv[3]));
+        return 0;
+    }
+
+    if (cmd == "checkpoint" && argc == 5) {
+        int64_t seq = 0;
+        if (parseSeq(argv[4], seq) == false) {
+            fprintf(stderr, "Invalid sequence number '%s'\n", argv[4]);
+            return printUsage(argv[0]);
+        }
+
+        return journal.setCheckpoint(argv[3], seq) ? 0 : -2;
+    }
+
+    return printUsage(argv[0]);
+}
@@ -0,0 +1,158 @@
+#include "node-index.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char kMagic[4] = { 'T', '2', 'N', 'I' };
+const int32_t kVersion = 1;
+
+}
+
+namespace T2D {
+
+NodeIndex::NodeIndex() {}
+
+NodeIndex::~NodeIndex() {}
+
+bool NodeIndex::load(const std::string & fname) {
+    m_records.clear();
+
+    std::ifstream fin(fname, std::ios::binary);
+    if (fin.good() == false) {
+        fprintf(stderr, "Failed to open node index '%s'\n", fname.c_str());
+        return false;
+    }
+
+    char magic[4];
+    int32_t version = 0;
+    int64_t n = 0;
+    fin.read(magic, sizeof(magic));
+    fin.read((char *) &version, sizeof(version));
+    fin.read((char *) &n, sizeof(n));
+
+    if (fin.good() == false || memcmp(magic, kMagic, sizeof(magic)) != 0 || version != kVersion || n < 0) {
+        fprintf(stderr, "Invalid node index '%s'\n", fname.c_str());
+        return false;
+    }
+
+    m_records.resize(n);
+    fin.read((char *) m_records.data(), n*sizeof(Record));
+
+    if (fin.good() == false) {
+        fprintf(stderr, "Truncated node index '%s'\n", fname.c_str());
+        m_records.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool NodeIndex::save(const std::string & fname) const {
+    const int64_t n = m_records.size();
+
+    std::string data;
+    data.reserve(sizeof(kMagic) + sizeof(kVersion) + sizeof(n) + n*sizeof(Record));
+    data.append(kMagic, sizeof(kMagic));
+    data.append((const char *) &kVersion, sizeof(kVersion));
+    data.append((const char *) &n, sizeof(n));
+    data.append((const char *) m_records.data(), n*sizeof(Record));
+
+    return writeFile(fname, data);
+}
+
+bool NodeIndex::build(const std::string & dataPath) {
+    m_records.clear();
+
+    std::vector<std::string> names;
+    if (listDir(dataPath + "/nodes", names) == false) return false;
+
+    m_records.reserve(names.size());
+
+    Record record;
+    for (const auto & name : names) {
+        NodeId id = 0;
+        if (parseNodeId(name, id) == false) continue;
+        if (readRecord(dataPath, id, record) == false) continue;
+
+        m_records.push_back(record);
+    }
+
+    sort();
+
+    return true;
+}
+
+bool NodeIndex::update(const std::string & dataPath, const std::vector<NodeId> & ids) {
+    if (ids.empty()) return true;
+
+    std::unordered_map<NodeId, size_t> pos;
+    pos.reserve(m_records.size());
+    for (size_t i = 0; i < m_records.size(); ++i) {
+        pos[m_records[i].id] = i;
+    }
+
+    Record record;
+    for (const auto id : ids) {
+        if (readRecord(dataPath, id, record) == false) continue;
+
+        const auto it = pos.find(id);
+        if (it != pos.end()) {
+            m_records[it->second] = record;
+        } else {
+            pos[id] = m_records.size();
+            m_records.push_back(record);
+        }
+    }
+
+    sort();
+
+    return true;
+}
+
+void NodeIndex::filter(const Filter & filter, std::vector<const Record *> & res) const {
+    // frames are in descending order - [begin, end) has maxFrames >= frames >= minFrames
+    const auto begin = std::lower_bound(m_records.begin(), m_records.end(), filter.maxFrames,
+                                        [](const Record & r, int32_t v) { return r.frames > v; });
+    const auto end = std::lower_bound(begin, m_records.end(), filter.minFrames,
+                                      [](const Record & r, int32_t v) { return r.frames >= v; });
+
+    for (auto it = begin; it != end; ++it) {
+        if (it->depth < filter.minDepth || it->depth > filter.maxDepth) continue;
+        res.push_back(&*it);
+    }
+}
+
+bool NodeIndex::readRecord(const std::string & dataPath, NodeId id, Record & res) {
+    const auto path = dataPath + "/nodes/" + std::to_string(id);
+
+    int64_t depth = 0;
+    if (readInt(path + "/depth", depth) == false) return false;
+
+    // frames and parent_id are missing for the root node
+    int64_t frames = 0;
+    readInt(path + "/frames", frames);
+
+    int64_t parentId = 0;
+    readInt(path + "/parent_id", parentId);
+
+    res.id = id;
+    res.parentId = parentId;
+    res.depth = (int32_t) depth;
+    res.frames = (int32_t) frames;
+
+    return true;
+}
+
+void NodeIndex::sort() {
+    std::sort(m_records.begin(), m_records.end(), [](const Record & a, const Record & b) {
+        if (a.frames != b.frames) return a.frames > b.frames;
+        if (a.depth != b.depth) return a.depth > b.depth;
+        return a.id < b.id;
+    });
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "common.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace T2D {
+
+// Compact index of the depth and frames of all nodes, used to select nodes for rendering
+//
+// The records are kept sorted by frames in descending order, so that a frame range is found with a binary
+// search and only the records inside it are tested against the depth range. The index is saved as a flat
+// binary file and updated incrementally with the nodes from the change journal.
+//
+class NodeIndex {
+public:
+    struct Record {
+        NodeId id = 0;
+        NodeId parentId = 0;
+        int32_t depth = 0;
+        int32_t frames = 0;
+    };
+
+    struct Filter {
+        int32_t minDepth = 0;
+        int32_t maxDepth = INT32_MAX;
+        int32_t minFrames = 0;
+        int32_t maxFrames = INT32_MAX;
+    };
+
+    NodeIndex();
+    ~NodeIndex();
+
+    bool load(const std::string & fname);
+    bool save(const std::string & fname) const;
+
+    // scans all folders in <dataPath>/nodes
+    bool build(const std::string & dataPath);
+
+    // re-reads the given nodes from <dataPath>/nodes and adds or replaces their records
+    bool update(const std::string & dataPath, const std::vector<NodeId> & ids);
+
+    // records that pass the filter, in descending order of frames
+    void filter(const Filter & filter, std::vector<const Record *> & res) const;
+
+    int getNumRecords() const { return (int) m_records.size(); }
+
+private:
+    static bool readRecord(const std::string & dataPath, NodeId id, Record & res);
+
+    void sort();
+
+    std::vector<Record> m_records;
+};
+
+}
@@ -0,0 +1,152 @@
+// Node index used to select the nodes for rendering
+//
+// Usage:
+//
+//   t2d-nodes update path/to/journal path/to/data
+//      adds the nodes from the journal entries since the last update to the index (full scan on the first run)
+//
+//   t2d-nodes query path/to/journal [-dMIN_DEPTH] [-DMAX_DEPTH] [-fMIN_FRAMES] [-FMAX_FRAMES] [-nCOUNT] [-kdepth|frames]
+//      prints the ids of COUNT (default: 1) nodes that pass the filter - a uniform random sample,
+//      or the top COUNT nodes by depth or frames if -k is given
+//
+// The index is stored in path/to/journal/nodes.idx
+//
+
+#include "common.h"
+#include "change-journal.h"
+#include "node-index.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char * kStage = "nodes";
+
+int printUsage(const char * argv0) {
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "  %s update path/to/journal path/to/data\n", argv0);
+    fprintf(stderr, "  %s query path/to/journal [-dMIN_DEPTH] [-DMAX_DEPTH] [-fMIN_FRAMES] [-FMAX_FRAMES] [-nCOUNT] [-kdepth|frames]\n", argv0);
+    return -1;
+}
+
+std::string getIndexPath(const std::string & journalPath) {
+    return journalPath + "/nodes.idx";
+}
+
+int doUpdate(const std::string & journalPath, const std::string & dataPath) {
+    T2D::ChangeJournal journal;
+    if (journal.open(journalPath) == false) return -2;
+
+    const auto tStart = std::chrono::high_resolution_clock::now();
+
+    const auto fname = getIndexPath(journalPath);
+    const auto last = journal.getLastSeq();
+
+    T2D::NodeIndex index;
+    if (T2D::fileExists(fname) == false || index.load(fname) == false) {
+        printf("Building the node index from '%s'\n", dataPath.c_str());
+        if (index.build(dataPath) == false) return -3;
+    } else {
+        std::vector<T2D::ChangeJournal::Entry> entries;
+        if (journal.readPending(kStage, entries) == false) return -3;
+
+        std::vector<T2D::NodeId> ids;
+        for (const auto & entry : entries) {
+            if (entry.seq > last) break;
+            if (entry.kind != T2D::ChangeJournal::Kind::Node) continue;
+            ids.push_back(entry.id);
+        }
+
+        printf("Updating %d nodes in the node index\n", (int) ids.size());
+        if (index.update(dataPath, ids) == false) return -3;
+    }
+
+    if (index.save(fname) == false) return -4;
+    if (journal.setCheckpoint(kStage, last) == false) return -5;
+
+    const auto tEnd = std::chrono::high_resolution_clock::now();
+
+    printf("Node index: %d nodes, updated in %.3f ms\n", index.getNumRecords(), T2D::getTime_ms(tStart, tEnd));
+
+    return 0;
+}
+
+int doQuery(const std::string & journalPath, const std::map<std::string, std::string> & args) {
+    const auto getArg = [&](const char * name, int32_t def) {
+        const auto it = args.find(name);
+        return (it == args.end() || it->second.empty()) ? def : (int32_t) std::stol(it->second);
+    };
+
+    T2D::NodeIndex::Filter filter;
+    filter.minDepth  = getArg("d", filter.minDepth);
+    filter.maxDepth  = getArg("D", filter.maxDepth);
+    filter.minFrames = getArg("f", filter.minFrames);
+    filter.maxFrames = getArg("F", filter.maxFrames);
+
+    const int count = getArg("n", 1);
+    const std::string score = args.count("k") ? args.at("k") : "";
+
+    if (score != "" && score != "depth" && score != "frames") {
+        fprintf(stderr, "Unknown score '%s'\n", score.c_str());
+        return -2;
+    }
+
+    T2D::NodeIndex index;
+    if (index.load(getIndexPath(journalPath)) == false) return -3;
+
+    std::vector<const T2D::NodeIndex::Record *> matches;
+    index.filter(filter, matches);
+
+    fprintf(stderr, "Total nodes: %d\n", (int) matches.size());
+
+    const int n = std::min<int>(count, matches.size());
+
+    if (score == "frames") {
+        // already in descending order of frames
+    } else if (score == "depth") {
+        std::partial_sort(matches.begin(), matches.begin() + n, matches.end(), [](const auto & a, const auto & b) {
+            if (a->depth != b->depth) return a->depth > b->depth;
+            return a->frames > b->frames;
+        });
+    } else {
+        // partial Fisher-Yates shuffle - the first n are a uniform sample
+        std::mt19937_64 rng(std::random_device{}());
+        for (int i = 0; i < n; ++i) {
+            std::uniform_int_distribution<size_t> dist(i, matches.size() - 1);
+            std::swap(matches[i], matches[dist(rng)]);
+        }
+    }
+
+    for (int i = 0; i < n; ++i) {
+        printf("%" PRId64 "\n", matches[i]->id);
+    }
+
+    return 0;
+}
+
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 3) return printUsage(argv[0]);
+
+    const std::string cmd = argv[1];
+
+    if (cmd == "update" && argc == 4) {
+        return doUpdate(argv[2], argv[3]);
+    }
+
+    if (cmd == "query") {
+        for (int i = 3; i < argc; ++i) {
+            if (argv[i][0] != '-' || argv[i][1] == 0) return printUsage(argv[0]);
+        }
+
+        return doQuery(argv[2], T2D::parseCmdArguments(argc, argv));
+    }
+
+    return printUsage(argv[0]);
+}
@@ -0,0 +1,320 @@
+// Watches the tweet2doom data folders and runs the incremental pipeline stages as soon as new data lands
+//
+// Usage:
+//
+//   t2d-pipeline [-sSOURCE] [-dDEBOUNCE] [-mMAX_DELAY] [-cCOMMIT_INTERVAL] [-pPOLL_INTERVAL]
+//
+//   -s  path to the tweet2doom folder with nodes/ and processed/ (default: ../tweet2doom)
+//   -d  seconds without new events before the stages are run (default: 5)
+//   -m  max seconds between the first event of a burst and the stages run (default: 60)
+//   -c  min seconds between two commits of the public repo (default: 600)
+//   -p  seconds after which the stages are run even without events (default: 1800)
+//
+// Must be started from the root of this repo - the stages are the existing scripts:
+//
+//   ./sync.sh            - copy the new data, import the histories, append to the journal
+//   ./generate-graph.sh  - only if the journal has pending entries
+//   ./stats.sh
+//   ./publish.sh         - commit and push the public repo, at most once per commit interval
+//
+
+#include "common.h"
+#include "change-journal.h"
+
+#include <sys/inotify.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using TimePoint = std::chrono::time_point<Clock>;
+
+const char * kJournalPath = "./journal";
+const char * kGraphStage = "graph";
+
+volatile sig_atomic_t g_stop = 0;
+
+void onSignal(int) {
+    g_stop = 1;
+}
+
+int printUsage(const char * argv0) {
+    fprintf(stderr, "Usage: %s [-sSOURCE] [-dDEBOUNCE] [-mMAX_DELAY] [-cCOMMIT_INTERVAL] [-pPOLL_INTERVAL]\n", argv0);
+    return -1;
+}
+
+float getElapsed_s(const TimePoint & tStart, const TimePoint & tEnd) {
+    return 0.001f*T2D::getTime_ms(tStart, tEnd);
+}
+
+void printTimestamp(const char * msg) {
+    const time_t t = time(nullptr);
+    char buf[64];
+    strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", localtime(&t));
+    printf("[%s] %s\n", buf, msg);
+    fflush(stdout);
+}
+
+bool runStage(const char * cmd) {
+    printTimestamp(cmd);
+
+    const auto tStart = Clock::now();
+    const int ret = system(cmd);
+    const auto tEnd = Clock::now();
+
+    if (ret != 0) {
+        fprintf(stderr, "Stage '%s' failed with code %d\n", cmd, ret);
+        return false;
+    }
+
+    printf("    done in %.3f s\n", getElapsed_s(tStart, tEnd));
+    fflush(stdout);
+
+    return true;
+}
+
+int64_t getNumPending() {
+    T2D::ChangeJournal journal;
+    if (journal.open(kJournalPath) == false) return 0;
+
+    return journal.getLastSeq() - journal.getCheckpoint(kGraphStage);
+}
+
+// inotify watches are not recursive - every <id> folder gets its own watch, so that files written
+// into an existing folder are noticed too
+class Watcher {
+public:
+    ~Watcher() {
+        if (m_fd >= 0) close(m_fd);
+    }
+
+    bool init() {
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_fd < 0) {
+            fprintf(stderr, "inotify_init1 failed: %s\n", strerror(errno));
+            return false;
+        }
+
+        return true;
+    }
+
+    bool addTree(const std::string & path) {
+        if (addWatch(path, true) == false) return false;
+
+        std::vector<std::string> entries;
+        if (T2D::listDir(path, entries) == false) return false;
+
+        for (const auto & name : entries) {
+            const auto sub = path + "/" + name;
+            if (T2D::isDirectory(sub)) addWatch(sub, false);
+        }
+
+        return true;
+    }
+
+    // returns the number of events read, -1 on error
+    int read() {
+        alignas(inotify_event) char buf[64*1024];
+
+        int nEvents = 0;
+        while (true) {
+            const auto n = ::read(m_fd, buf, sizeof(buf));
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EINTR) break;
+                fprintf(stderr, "inotify read failed: %s\n", strerror(errno));
+                return -1;
+            }
+            if (n == 0) break;
+
+            for (char * p = buf; p < buf + n; ) {
+                const auto * event = (const inotify_event *) p;
+                p += sizeof(inotify_event) + event->len;
+
+                ++nEvents;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    fprintf(stderr, "inotify queue overflow - some events were lost\n");
+                    continue;
+                }
+
+                if (event->mask & IN_IGNORED) {
+                    m_watches.erase(event->wd);
+                    continue;
+                }
+
+                // a new <id> folder in one of the roots
+                const auto it = m_watches.find(event->wd);
+                if (it != m_watches.end() && it->second.isRoot && (event->mask & IN_ISDIR) && event->len > 0) {
+                    addWatch(it->second.path + "/" + event->name, false);
+                }
+            }
+        }
+
+        return nEvents;
+    }
+
+    int getFd() const { return m_fd; }
+    int getNumWatches() const { return (int) m_watches.size(); }
+
+private:
+    struct Watch {
+        std::string path;
+        bool isRoot = false;
+    };
+
+    bool addWatch(const std::string & path, bool isRoot) {
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR;
+
+        const int wd = inotify_add_watch(m_fd, path.c_str(), mask);
+        if (wd < 0) {
+            // running out of watches is not fatal - the new folders in the roots are still noticed
+            if (errno == ENOSPC && m_hasWarnedLimit == false) {
+                fprintf(stderr, "Reached the inotify watch limit (fs.inotify.max_user_watches) at %d watches\n", getNumWatches());
+                m_hasWarnedLimit = true;
+            } else if (errno != ENOSPC) {
+                fprintf(stderr, "Failed to watch '%s': %s\n", path.c_str(), strerror(errno));
+            }
+            return false;
+        }
+
+        m_watches[wd] = { path, isRoot };
+
+        return true;
+    }
+
+    int m_fd = -1;
+    bool m_hasWarnedLimit = false;
+
+    std::map<int, Watch> m_watches;
+};
+
+}
+
+int main(int argc, char ** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] != '-' || strlen(argv[i]) < 2) return printUsage(argv[0]);
+    }
+
+    const auto args = T2D::parseCmdArguments(argc, argv);
+
+    const auto getArg = [&](const char * name, const std::string & def) {
+        const auto it = args.find(name);
+        return (it == args.end() || it->second.empty()) ? def : it->second;
+    };
+
+    const std::string source = getArg("s", "../tweet2doom");
+    const float tDebounce_s  = std::stof(getArg("d", "5"));
+    const float tMaxDelay_s  = std::stof(getArg("m", "60"));
+    const float tCommit_s    = std::stof(getArg("c", "600"));
+    const float tPoll_s      = std::stof(getArg("p", "1800"));
+
+    if (T2D::fileExists("./sync.sh") == false) {
+        fprintf(stderr, "Must be started from the root of the repo\n");
+        return -2;
+    }
+
+    Watcher watcher;
+    if (watcher.init() == false) return -3;
+
+    for (const auto & tree : { source + "/nodes", source + "/processed" }) {
+        if (watcher.addTree(tree) == false) {
+            fprintf(stderr, "Failed to watch '%s'\n", tree.c_str());
+            return -4;
+        }
+    }
+
+    printf("Watching '%s' with %d watches\n", source.c_str(), watcher.getNumWatches());
+    printf("Debounce %.1f s, max delay %.1f s, commit interval %.1f s, poll interval %.1f s\n",
+           tDebounce_s, tMaxDelay_s, tCommit_s, tPoll_s);
+    fflush(stdout);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    // the first update catches anything that landed while the daemon was not running
+    bool isDirty = true;
+    bool isUnpublished = false;
+
+    auto tFirstEvent = Clock::now();
+    auto tLastEvent = tFirstEvent;
+    auto tLastUpdate = tFirstEvent;
+    auto tLastCommit = tFirstEvent;
+
+    bool isCommitDue = true;
+
+    while (g_stop == 0) {
+        pollfd pfd = { watcher.getFd(), POLLIN, 0 };
+        const int ret = poll(&pfd, 1, 500);
+        if (ret < 0 && errno != EINTR) {
+            fprintf(stderr, "poll failed: %s\n", strerror(errno));
+            return -5;
+        }
+
+        const auto tNow = Clock::now();
+
+        if (ret > 0) {
+            const int nEvents = watcher.read();
+            if (nEvents < 0) return -6;
+            if (nEvents > 0) {
+                if (isDirty == false) tFirstEvent = tNow;
+                tLastEvent = tNow;
+                isDirty = true;
+            }
+        }
+
+        const bool isQuiet   = isDirty && getElapsed_s(tLastEvent, tNow) >= tDebounce_s;
+        const bool isOverdue = isDirty && getElapsed_s(tFirstEvent, tNow) >= tMaxDelay_s;
+        const bool isPoll    = getElapsed_s(tLastUpdate, tNow) >= tPoll_s;
+
+        if (isQuiet || isOverdue || isPoll) {
+            isDirty = false;
+            tLastUpdate = tNow;
+
+            if (runStage("./sync.sh > log-sync.txt")) {
+                const auto nPending = getNumPending();
+                if (nPending > 0) {
+                    printf("New journal entries: %" PRId64 "\n", nPending);
+
+                    if (runStage("./generate-graph.sh") && runStage("./stats.sh > log-stats.txt")) {
+                        isUnpublished = true;
+                    }
+                }
+            }
+        }
+
+        // updates are published in batches, so that the commit rate does not depend on the event rate
+        if (isCommitDue == false) {
+            isCommitDue = getElapsed_s(tLastCommit, Clock::now()) >= tCommit_s;
+        }
+
+        if (isUnpublished && isCommitDue) {
+            // a failed publish is retried on the next interval
+            if (runStage("./publish.sh")) {
+                isUnpublished = false;
+            }
+            isCommitDue = false;
+            tLastCommit = Clock::now();
+        }
+    }
+
+    if (isUnpublished) {
+        runStage("./publish.sh");
+    }
+
+    printTimestamp("Stopped");
+
+    return 0;
+}
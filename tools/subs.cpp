@@ -0,0 +1,150 @@
+// Builds the subtitles of a video made of several rendered clips
+//
+// Usage:
+//
+//   t2d-subs path/to/subs.srt path/to/commands id0 [id1 ...] [-nCUES] [-lCUE_MS] [-fFRAMES -rFRAMERATE] [-aSTART_MS -bEND_MS -tTEXT]
+//
+//   path/to/commands/command_<id> are the files produced by parse-history, one line per cue
+//
+//   -n  cues per clip (default: 20)
+//   -l  length of a cue in milliseconds (default: 1000)
+//   -f  frames per cue, with -r the framerate of the video - alternative to -l
+//   -a  start, -b end and -t text of an extra cue after the last clip - "\n" in the text starts a new line
+//
+// The clips are placed one after another in the order of the ids.
+//
+
+#include "common.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+int printUsage(const char * argv0) {
+    fprintf(stderr, "Usage: %s path/to/subs.srt path/to/commands id0 [id1 ...] [-nCUES] [-lCUE_MS] [-fFRAMES -rFRAMERATE] [-aSTART_MS -bEND_MS -tTEXT]\n", argv0);
+    return -1;
+}
+
+// HH:MM:SS,mmm - the old bash loop never carried the seconds into minutes and wrote 00:00:60,000 and up
+void appendTimestamp(std::string & res, int64_t t_ms) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%02" PRId64 ":%02" PRId64 ":%02" PRId64 ",%03" PRId64,
+             t_ms/3600000, (t_ms/60000)%60, (t_ms/1000)%60, t_ms%1000);
+    res += buf;
+}
+
+void appendCue(std::string & res, int index, int64_t tStart_ms, int64_t tEnd_ms, const std::string & text) {
+    res += std::to_string(index);
+    res += "\n";
+    appendTimestamp(res, tStart_ms);
+    res += " --> ";
+    appendTimestamp(res, tEnd_ms);
+    res += "\n";
+    res += text;
+    res += "\n\n";
+}
+
+bool readLines(const std::string & fname, std::vector<std::string> & res) {
+    std::string data;
+    if (T2D::readFile(fname, data) == false) return false;
+
+    size_t pos = 0;
+    while (pos < data.size()) {
+        auto end = data.find('\n', pos);
+        if (end == std::string::npos) end = data.size();
+        res.push_back(data.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    return true;
+}
+
+std::string unescapeNewlines(const std::string & s) {
+    std::string res;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '\\' && i + 1 < s.size() && s[i + 1] == 'n') {
+            res += '\n';
+            ++i;
+        } else {
+            res += s[i];
+        }
+    }
+
+    return res;
+}
+
+}
+
+int main(int argc, char ** argv) {
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] == '-') {
+            if (argv[i][1] == 0) return printUsage(argv[0]);
+            continue;
+        }
+        positional.push_back(argv[i]);
+    }
+
+    if (positional.size() < 3) return printUsage(argv[0]);
+
+    const auto args = T2D::parseCmdArguments(argc, argv);
+
+    const auto getArg = [&](const char * name, double def) {
+        const auto it = args.find(name);
+        return (it == args.end() || it->second.empty()) ? def : std::stod(it->second);
+    };
+
+    const std::string fnameOut = positional[0];
+    const std::string pathCommands = positional[1];
+    const std::vector<std::string> ids(positional.begin() + 2, positional.end());
+
+    const int nCues = getArg("n", 20);
+
+    double tCue_ms = getArg("l", 1000.0);
+    if (args.count("f") || args.count("r")) {
+        const double framerate = getArg("r", 0.0);
+        if (framerate <= 0.0) {
+            fprintf(stderr, "Frames per cue (-f) require a framerate (-r)\n");
+            return -2;
+        }
+        tCue_ms = 1000.0*getArg("f", 0.0)/framerate;
+    }
+
+    if (nCues <= 0 || tCue_ms <= 0.0) {
+        fprintf(stderr, "Invalid number of cues %d or cue length %g ms\n", nCues, tCue_ms);
+        return -2;
+    }
+
+    std::string res;
+
+    int index = 0;
+    std::vector<std::string> lines;
+    for (const auto & id : ids) {
+        lines.clear();
+        if (readLines(pathCommands + "/command_" + id, lines) == false) return -3;
+
+        // clips with fewer commands than cues repeat the last one, as the original bash loop did
+        for (int k = 0; k < nCues; ++k, ++index) {
+            const std::string & text = lines.empty() ? "" : lines[std::min<size_t>(k, lines.size() - 1)];
+            appendCue(res, index + 1, (int64_t) (tCue_ms*index + 0.5), (int64_t) (tCue_ms*(index + 1) + 0.5), text);
+        }
+    }
+
+    if (args.count("t")) {
+        const int64_t tStart_ms = getArg("a", tCue_ms*index);
+        const int64_t tEnd_ms = getArg("b", tStart_ms + tCue_ms);
+        appendCue(res, index + 1, tStart_ms, tEnd_ms, unescapeNewlines(args.at("t")));
+    }
+
+    if (T2D::writeFile(fnameOut, res) == false) return -4;
+
+    printf("Written %d cues to '%s'\n", index + (args.count("t") ? 1 : 0), fnameOut.c_str());
+
+    return 0;
+}
@@ -10,6 +10,22 @@ cp -v build-em/bin/t2d-explorer.data ./public/
 cp -v build-em/bin/t2d-explorer.js   ./public/
 cp -v build-em/bin/t2d-explorer.wasm ./public/
 
+# optional variants, each in its own build folder:
+#   build-em-mt       - cmake -DT2DD_USE_THREADS=ON
+#   build-em-simd     - cmake -DT2DD_WASM_SIMD=ON
+#   build-em-mt-simd  - cmake -DT2DD_USE_THREADS=ON -DT2DD_WASM_SIMD=ON
+for variant in mt simd mt-simd ; do
+    name=t2d-explorer-$variant
+    if [ -f build-em-$variant/bin/$name.js ] ; then
+        cp -v build-em-$variant/bin/$name.data ./public/
+        cp -v build-em-$variant/bin/$name.js   ./public/
+        cp -v build-em-$variant/bin/$name.wasm ./public/
+        if [ -f build-em-$variant/bin/$name.worker.js ] ; then
+            cp -v build-em-$variant/bin/$name.worker.js ./public/
+        fi
+    fi
+done
+
 cp -v build-em/bin/t2d-explorer-extra/style.css        ./public/
 cp -v build-em/bin/t2d-explorer-extra/index.html       ./public/
 cp -v build-em/bin/t2d-explorer-extra/gghelpers.js     ./public/js/